@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 9:40:26pm
+    Author:  StoneyDSP
+
+    Replays automation heavy sessions through the plugin with the real-time
+    safety checks on, and fails if processBlock allocates or blocks.
+
+  ==============================================================================
+*/
+
+#include <iostream>
+#include "../../Source/PluginProcessor.h"
+
+//==============================================================================
+namespace
+{
+    struct Scenario
+    {
+        const char* name;
+        juce::AudioChannelSet channelSet;
+        bool splitBuses;
+    };
+
+    /** Every layout runs on the same instance, one after the other, so each is
+        also a re-prepare for a new bus layout, as when a host changes it.
+    */
+    const Scenario scenarios[] =
+    {
+        { "mono",                 juce::AudioChannelSet::mono(),          false },
+        { "stereo",               juce::AudioChannelSet::stereo(),        false },
+        { "stereo, split buses",  juce::AudioChannelSet::stereo(),        true },
+        { "7.1",                  juce::AudioChannelSet::create7point1(), false },
+        { "3rd order ambisonic",  juce::AudioChannelSet::ambisonic(3),    false },
+        { "7th order ambisonic",  juce::AudioChannelSet::ambisonic(7),    true },
+    };
+
+    /** Sample rates and block sizes the host prepares with, in turn. */
+    const std::pair<double, int> configurations[] = { { 48000.0, 512 }, { 96000.0, 128 }, { 44100.0, 1024 } };
+
+    void setParameter(SVF1AudioProcessor& processor, const juce::String& parameterID, float value)
+    {
+        auto* parameter = processor.apvts.getParameter(parameterID);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    /** Plays numBlocks blocks for each configuration, with the parameters set
+        between blocks the way a host's automation would set them, at the
+        processing precision of SampleType.
+    */
+    template <typename SampleType>
+    void replay(SVF1AudioProcessor& processor, const Scenario& scenario, int numBlocks, juce::Random& random)
+    {
+        auto layout = processor.getBusesLayout();
+        layout.inputBuses.getReference(0) = scenario.channelSet;
+        layout.outputBuses.getReference(0) = scenario.channelSet;
+
+        for (int bus = 1; bus < layout.outputBuses.size(); ++bus)
+            layout.outputBuses.getReference(bus) = scenario.splitBuses ? scenario.channelSet
+                                                                       : juce::AudioChannelSet::disabled();
+
+        processor.releaseResources();
+
+        if (! processor.setBusesLayout(layout))
+        {
+            std::cerr << scenario.name << ": layout not supported" << std::endl;
+            return;
+        }
+
+        const auto numChannels = juce::jmax(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+        juce::MidiBuffer midi;
+
+        for (const auto& configuration : configurations)
+        {
+            const auto sampleRate = configuration.first;
+            const auto maxBlockSize = configuration.second;
+
+            processor.releaseResources();
+            processor.setProcessingPrecision(std::is_same<SampleType, double>::value ? juce::AudioProcessor::doublePrecision
+                                                                                     : juce::AudioProcessor::singlePrecision);
+            processor.setRateAndBufferSizeDetails(sampleRate, maxBlockSize);
+            processor.prepareToPlay(sampleRate, maxBlockSize);
+
+            juce::AudioBuffer<SampleType> buffer(numChannels, maxBlockSize);
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                // A log sweep over the whole cutoff range every 500 blocks, a new
+                // type every 16, a morph there and back every 100 towards a new
+                // type every 60, a new slope every 40, a new drive every 30, off a
+                // third of the time so that the saturation starts and stops, and a
+                // new oversampling factor every 50.
+                const auto phase = (float) (block % 500) / 500.0f;
+                setParameter(processor, "cutoff", 20.0f * std::pow(1000.0f, phase));
+                setParameter(processor, "type", (float) ((block / 16) % 11));
+                setParameter(processor, "morph", std::abs((float) (block % 100) / 50.0f - 1.0f));
+
+                if (block % 60 == 0)
+                    setParameter(processor, "morphType", (float) random.nextInt(11));
+
+                if (block % 40 == 0)
+                    setParameter(processor, "slope", (float) random.nextInt(4));
+
+                if (block % 10 == 0)
+                    setParameter(processor, "resonance", 0.707107f + random.nextFloat() * 20.0f);
+
+                if (block % 25 == 0)
+                    setParameter(processor, "mix", random.nextFloat());
+
+                if (block % 30 == 0)
+                    setParameter(processor, "drive", random.nextInt(3) == 0 ? 0.0f : random.nextFloat() * 8.0f);
+
+                if (block % 50 == 0)
+                    setParameter(processor, "oversampling", (float) random.nextInt(4));
+
+                setParameter(processor, "bypass", block % 200 >= 190 ? 1.0f : 0.0f);
+
+                // The middle third is an offline bounce, which some hosts start
+                // and end without preparing again. The blocks after it must
+                // be real-time safe again.
+                processor.setNonRealtime(block >= numBlocks / 3 && block < 2 * numBlocks / 3);
+
+                // Hosts pass shorter blocks at loop points and the like.
+                const auto numSamples = block % 7 == 0 ? random.nextInt({ 1, maxBlockSize + 1 }) : maxBlockSize;
+                buffer.setSize(numChannels, numSamples, false, false, true);
+
+                // Stretches of silence, long enough for a plain low pass to ring
+                // out, so that the idle path runs too.
+                const auto isSilent = block % 250 >= 200;
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    for (int i = 0; i < numSamples; ++i)
+                        buffer.setSample(channel, i, static_cast<SampleType> (isSilent ? 0.0f : random.nextFloat() * 0.5f - 0.25f));
+
+                processor.processBlock(buffer, midi);
+            }
+        }
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h"))
+    {
+        std::cout << "Usage: SVF1Audit [--blocks=<n>] [--seed=<n>]" << std::endl
+                  << std::endl
+                  << "Replays automation through every bus layout, in real time and with an" << std::endl
+                  << "offline bounce in the middle, and reports anything processBlock" << std::endl
+                  << "allocates or blocks on in real time, with a stack trace." << std::endl;
+        return 0;
+    }
+
+    if (! RealtimeSafety::areChecksEnabled())
+    {
+        std::cerr << "Built without SVF1_REALTIME_SAFETY_CHECKS, so nothing would be caught." << std::endl;
+        return 1;
+    }
+
+    const auto numBlocks = args.containsOption("--blocks") ? juce::jmax(1, args.getValueForOption("--blocks").getIntValue()) : 2000;
+    juce::Random random(args.containsOption("--seed") ? args.getValueForOption("--seed").getLargeIntValue() : 0x5f1);
+
+    SVF1AudioProcessor processor;
+
+    // The editor's timing readout and spectra, so that their halves of
+    // processBlock run too.
+    processor.getPerformanceMonitor().addUser();
+    processor.getSpectrumAnalyser().addUser();
+
+    auto numViolations = 0;
+
+    for (const auto& scenario : scenarios)
+    {
+        // Each layout in the host's usual precision and then in double, which
+        // is also a re-prepare for a new precision.
+        for (auto precision : { "float", "double" })
+        {
+            RealtimeSafety::resetNumViolations();
+
+            if (juce::String(precision) == "double")
+                replay<double>(processor, scenario, numBlocks, random);
+            else
+                replay<float>(processor, scenario, numBlocks, random);
+
+            std::cout << scenario.name << " (" << precision << "): " << RealtimeSafety::getNumViolations() << " violations" << std::endl;
+            numViolations += RealtimeSafety::getNumViolations();
+        }
+    }
+
+    processor.getSpectrumAnalyser().removeUser();
+    processor.getPerformanceMonitor().removeUser();
+    processor.releaseResources();
+
+    return numViolations == 0 ? 0 : 1;
+}
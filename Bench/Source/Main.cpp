@@ -0,0 +1,504 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 4:05:52pm
+    Author:  StoneyDSP
+
+    Times the filter kernels, the filter bank, the plugin's processBlock and
+    its state, and writes the results as CSV or JSON so that releases can be
+    compared.
+
+  ==============================================================================
+*/
+
+#include <iostream>
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/SVFBank.h"
+
+//==============================================================================
+namespace
+{
+    struct BenchmarkResult
+    {
+        juce::String benchmark, sampleType, filterType, parameters, variant;
+        int numChannels = 0, blockSize = 0;
+        double nsPerSample = 0.0;
+    };
+
+    struct BenchmarkOptions
+    {
+        /** Frames processed per timed run. Each result is the fastest of numRuns. */
+        int framesPerRun = 1 << 16;
+        int numRuns = 3;
+    };
+
+    const char* const typeNames[] = { "LP2", "LP1", "LP2n", "HP2", "HP1", "HP2n", "BP2", "BP2n", "AP2", "N2", "P2" };
+
+    /** What changes from one block to the next in the filter benchmark: nothing,
+        the cutoff, or the morph towards another type; or nothing, with the
+        filter saturating.
+    */
+    const char* const filterParameters[] = { "static", "per-block", "morph", "drive" };
+    const int channelCounts[] = { 1, 2, 8, 32, 64 };
+    const int blockSizes[] = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192 };
+
+    /** Runs processBlock(blockIndex) over options.framesPerRun frames, a few times,
+        and returns the fastest run in nanoseconds per sample of one channel.
+    */
+    template <typename Function>
+    double timeFastestRun(const BenchmarkOptions& options, int blockSize, int numChannels, Function&& processBlock)
+    {
+        const auto numBlocks = juce::jmax(1, options.framesPerRun / blockSize);
+        auto fastest = std::numeric_limits<double>::max();
+
+        for (int block = 0; block < numBlocks; ++block)     // warm up
+            processBlock(block);
+
+        for (int run = 0; run < options.numRuns; ++run)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int block = 0; block < numBlocks; ++block)
+                processBlock(block);
+
+            const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            fastest = juce::jmin(fastest, seconds);
+        }
+
+        return fastest * 1.0e9 / ((double) numBlocks * blockSize * numChannels);
+    }
+
+    template <typename SampleType>
+    void fillWithNoise(juce::AudioBuffer<SampleType>& buffer)
+    {
+        juce::Random random(0x5f1);
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample(channel, i, static_cast<SampleType> (random.nextFloat() * 0.5f - 0.25f));
+    }
+
+    //==============================================================================
+    /** StateVariableTPTFilter on its own, for every type, channel count, block
+        size, and with the cutoff either left alone or changed every block, or
+        with the output morphing towards the type three along the list, ramped
+        in every block, or with a drive of 4, which the noise goes well into.
+        The saturating filter costs the same whatever the level, so the last
+        is the price of the nonlinear mode against "static".
+    */
+    template <typename SampleType>
+    void benchmarkFilter(const BenchmarkOptions& options, const juce::String& sampleType, juce::Array<BenchmarkResult>& results)
+    {
+        for (int typeIndex = 0; typeIndex < (int) juce::numElementsInArray(typeNames); ++typeIndex)
+        {
+            for (auto numChannels : channelCounts)
+            {
+                for (auto blockSize : blockSizes)
+                {
+                    for (auto parameters : filterParameters)
+                    {
+                        const auto perBlock = juce::String(parameters) == "per-block";
+                        const auto morph = juce::String(parameters) == "morph";
+                        const auto drive = juce::String(parameters) == "drive";
+
+                        StateVariableTPTFilter<SampleType> filter;
+                        filter.prepare({ 48000.0, (juce::uint32) blockSize, (juce::uint32) numChannels });
+                        filter.setType((StateVariableTPTFilterType) typeIndex);
+                        filter.setCutoffFrequency(static_cast<SampleType> (1000));
+
+                        if (morph)
+                        {
+                            filter.setMorphType((StateVariableTPTFilterType) ((typeIndex + 3) % (int) juce::numElementsInArray(typeNames)));
+                            filter.setRampDurationSeconds(0.05);
+                        }
+
+                        if (drive)
+                            filter.setDrive(static_cast<SampleType> (4));
+
+                        // Separate input and output, so that the signal doesn't
+                        // build up from one run to the next.
+                        juce::AudioBuffer<SampleType> input(numChannels, blockSize), output(numChannels, blockSize);
+                        fillWithNoise(input);
+
+                        const auto inputBlock = juce::dsp::AudioBlock<const SampleType>(input);
+                        auto outputBlock = juce::dsp::AudioBlock<SampleType>(output);
+                        const auto context = juce::dsp::ProcessContextNonReplacing<SampleType>(inputBlock, outputBlock);
+
+                        const auto ns = timeFastestRun(options, blockSize, numChannels, [&](int block)
+                        {
+                            if (perBlock)
+                                filter.setCutoffFrequency(static_cast<SampleType> ((block & 1) != 0 ? 1000 : 1100));
+
+                            if (morph)
+                                filter.setMorphProportion(static_cast<SampleType> ((block & 1) != 0 ? 0.25 : 0.75));
+
+                            filter.process(context);
+                        });
+
+                        results.add({ "filter", sampleType, typeNames[typeIndex], parameters, {},
+                                      numChannels, blockSize, ns });
+                    }
+                }
+            }
+        }
+    }
+
+    /** One filter per voice, every voice a different type, cutoff and resonance,
+        with the cutoffs changed every block as a synth's envelopes would. Each
+        voice has a StateVariableTPTFilter<SampleType, 1> of its own in one
+        variant, and a channel of a StateVariableTPTFilterBank in the other.
+
+        Before timing, the two run the same input and their outputs are
+        compared: the bank computes the same arithmetic as the single filters,
+        so they should match to within rounding. Returns false if they don't.
+    */
+    template <typename SampleType>
+    bool benchmarkBank(const BenchmarkOptions& options, const juce::String& sampleType, juce::Array<BenchmarkResult>& results)
+    {
+        auto matches = true;
+
+        for (auto numVoices : { 8, 64, 256 })
+        {
+            for (auto blockSize : { 64, 256, 1024 })
+            {
+                StateVariableTPTFilterBank<SampleType> bank;
+                bank.prepare({ 48000.0, (juce::uint32) blockSize, (juce::uint32) numVoices });
+
+                std::vector<std::unique_ptr<StateVariableTPTFilter<SampleType, 1>>> filters;
+
+                auto getCutoff = [](int voice, int block)
+                {
+                    return static_cast<SampleType> (100 + 37 * voice + ((block & 1) != 0 ? 50 : 0));
+                };
+
+                for (int voice = 0; voice < numVoices; ++voice)
+                {
+                    const auto voiceType = (StateVariableTPTFilterType) (voice % (int) juce::numElementsInArray(typeNames));
+                    const auto voiceResonance = static_cast<SampleType> (0.707107 + 0.1 * (voice % 20));
+
+                    filters.push_back(std::make_unique<StateVariableTPTFilter<SampleType, 1>>());
+                    auto& filter = *filters.back();
+
+                    // The bank's coefficients are always the fast ones.
+                    filter.setCoefficientMode(StateVariableTPTFilterCoefficientMode::fast);
+                    filter.prepare({ 48000.0, (juce::uint32) blockSize, 1 });
+                    filter.setType(voiceType);
+                    filter.setResonance(voiceResonance);
+
+                    bank.setType((size_t) voice, voiceType);
+                    bank.setResonance((size_t) voice, voiceResonance);
+                }
+
+                juce::AudioBuffer<SampleType> input(numVoices, blockSize), bankOutput(numVoices, blockSize), filterOutput(numVoices, blockSize);
+                fillWithNoise(input);
+
+                const auto inputBlock = juce::dsp::AudioBlock<const SampleType>(input);
+                auto bankBlock = juce::dsp::AudioBlock<SampleType>(bankOutput);
+                auto filterBlock = juce::dsp::AudioBlock<SampleType>(filterOutput);
+
+                auto processBank = [&](int block)
+                {
+                    for (int voice = 0; voice < numVoices; ++voice)
+                        bank.setCutoffFrequency((size_t) voice, getCutoff(voice, block));
+
+                    bank.process(juce::dsp::ProcessContextNonReplacing<SampleType>(inputBlock, bankBlock));
+                };
+
+                auto processFilters = [&](int block)
+                {
+                    for (size_t voice = 0; voice < filters.size(); ++voice)
+                    {
+                        auto voiceOutput = filterBlock.getSingleChannelBlock(voice);
+                        filters[voice]->setCutoffFrequency(getCutoff((int) voice, block));
+                        filters[voice]->process(juce::dsp::ProcessContextNonReplacing<SampleType>(inputBlock.getSingleChannelBlock(voice), voiceOutput));
+                    }
+                };
+
+                // Long enough for the resonant voices to ring up. Float rounds
+                // differently in the two, by a few ulps a sample.
+                auto maxDifference = 0.0, peak = 0.0;
+
+                for (int block = 0; block < 32; ++block)
+                {
+                    processBank(block);
+                    processFilters(block);
+
+                    for (int voice = 0; voice < numVoices; ++voice)
+                    {
+                        for (int i = 0; i < blockSize; ++i)
+                        {
+                            const auto expected = (double) filterOutput.getSample(voice, i);
+                            maxDifference = juce::jmax(maxDifference, std::abs((double) bankOutput.getSample(voice, i) - expected));
+                            peak = juce::jmax(peak, std::abs(expected));
+                        }
+                    }
+                }
+
+                const auto tolerance = std::is_same<SampleType, float>::value ? 1.0e-5 : 1.0e-12;
+
+                if (maxDifference > tolerance * juce::jmax(1.0, peak))
+                {
+                    std::cerr << "The " << sampleType << " bank of " << numVoices << " voices differs from single filters by "
+                              << maxDifference << std::endl;
+                    matches = false;
+                }
+
+                results.add({ "bank", sampleType, "mixed", "per-block", "bank",
+                              numVoices, blockSize, timeFastestRun(options, blockSize, numVoices, processBank) });
+
+                results.add({ "bank", sampleType, "mixed", "per-block", "single filters",
+                              numVoices, blockSize, timeFastestRun(options, blockSize, numVoices, processFilters) });
+            }
+        }
+
+        return matches;
+    }
+
+    /** The whole SVF1AudioProcessor::processBlock, dry/wet mix included, on mono,
+        stereo, 7.1 and 7th order ambisonic (64 channel) buses, at the processing
+        precision of SampleType. Each block starts by copying fresh input into the
+        buffer, as a host would.
+    */
+    template <typename SampleType>
+    void benchmarkProcessor(const BenchmarkOptions& options, const juce::String& sampleType, juce::Array<BenchmarkResult>& results)
+    {
+        for (auto numChannels : { 1, 2, 8, 64 })
+        {
+            for (auto blockSize : blockSizes)
+            {
+                for (auto perBlock : { false, true })
+                {
+                    for (auto mix : { 1.0f, 0.5f })
+                    {
+                        for (auto oversampling : { 0, 2 })
+                        {
+                            SVF1AudioProcessor processor;
+
+                            const auto channelSet = numChannels == 64 ? juce::AudioChannelSet::ambisonic(7)
+                                                                      : juce::AudioChannelSet::canonicalChannelSet(numChannels);
+                            auto layout = processor.getBusesLayout();
+                            layout.inputBuses.getReference(0) = channelSet;
+                            layout.outputBuses.getReference(0) = channelSet;
+
+                            for (int bus = 1; bus < layout.outputBuses.size(); ++bus)
+                                layout.outputBuses.getReference(bus) = juce::AudioChannelSet::disabled();
+
+                            processor.setBusesLayout(layout);
+
+                            auto setParameter = [&processor](const juce::String& parameterID, float value)
+                            {
+                                auto* parameter = processor.apvts.getParameter(parameterID);
+                                parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+                            };
+
+                            setParameter("cutoff", 1000.0f);
+                            setParameter("mix", mix);
+                            setParameter("oversampling", (float) oversampling);
+
+                            processor.setProcessingPrecision(std::is_same<SampleType, double>::value ? juce::AudioProcessor::doublePrecision
+                                                                                                     : juce::AudioProcessor::singlePrecision);
+                            processor.setRateAndBufferSizeDetails(48000.0, blockSize);
+                            processor.prepareToPlay(48000.0, blockSize);
+
+                            juce::AudioBuffer<SampleType> input(numChannels, blockSize), buffer(numChannels, blockSize);
+                            juce::MidiBuffer midi;
+                            fillWithNoise(input);
+
+                            const auto ns = timeFastestRun(options, blockSize, numChannels, [&](int block)
+                            {
+                                if (perBlock)
+                                    setParameter("cutoff", (block & 1) != 0 ? 1000.0f : 1100.0f);
+
+                                buffer.makeCopyOf(input, true);
+                                processor.processBlock(buffer, midi);
+                            });
+
+                            processor.releaseResources();
+
+                            results.add({ "processBlock", sampleType, "LP2", perBlock ? "per-block" : "static",
+                                          "mix=" + juce::String(mix, 1) + " oversampling=" + juce::String(1 << oversampling) + "x",
+                                          numChannels, blockSize, ns });
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /** Saving and restoring the plugin state, in the binary format and in the
+        XML one that older sessions hold, over a session's worth of instances.
+        Results are in ns per instance, which is also us per 1000 instances.
+    */
+    void benchmarkState(const BenchmarkOptions& options, juce::Array<BenchmarkResult>& results)
+    {
+        const auto numInstances = options.framesPerRun < (1 << 16) ? 100 : 1000;
+
+        std::vector<std::unique_ptr<SVF1AudioProcessor>> instances;
+
+        for (int i = 0; i < numInstances; ++i)
+            instances.push_back(std::make_unique<SVF1AudioProcessor>());
+
+        auto& first = *instances.front();
+        auto* cutoff = first.apvts.getParameter("cutoff");
+        cutoff->setValueNotifyingHost(cutoff->convertTo0to1(1234.0f));
+
+        juce::MemoryBlock binaryState, xmlState;
+        first.getStateInformation(binaryState);
+
+        std::unique_ptr<juce::XmlElement> xml(first.apvts.copyState().createXml());
+        juce::AudioProcessor::copyXmlToBinary(*xml, xmlState);
+
+        auto timeInstances = [&](auto&& function)
+        {
+            auto fastest = std::numeric_limits<double>::max();
+
+            for (int run = 0; run <= options.numRuns; ++run)     // the first run warms up
+            {
+                const auto start = juce::Time::getHighResolutionTicks();
+
+                for (auto& instance : instances)
+                    function(*instance);
+
+                const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+                if (run > 0)
+                    fastest = juce::jmin(fastest, seconds);
+            }
+
+            return fastest * 1.0e9 / (double) numInstances;
+        };
+
+        for (auto* state : { &binaryState, &xmlState })
+        {
+            const auto format = state == &binaryState ? "binary" : "xml";
+
+            const auto load = timeInstances([state](SVF1AudioProcessor& p) { p.setStateInformation(state->getData(), (int) state->getSize()); });
+            results.add({ "state", {}, {}, "load", format, numInstances, 0, load });
+
+            // Both formats restore the same values.
+            auto* restored = instances.back()->apvts.getParameter("cutoff");
+            jassert(std::abs(restored->convertFrom0to1(restored->getValue()) - 1234.0f) < 0.01f);
+            juce::ignoreUnused(restored);
+        }
+
+        juce::MemoryBlock destination;
+
+        const auto save = timeInstances([&destination](SVF1AudioProcessor& p) { p.getStateInformation(destination); });
+        results.add({ "state", {}, {}, "save", "binary", numInstances, 0, save });
+
+        const auto saveXml = timeInstances([&destination](SVF1AudioProcessor& p)
+        {
+            std::unique_ptr<juce::XmlElement> element(p.apvts.copyState().createXml());
+            juce::AudioProcessor::copyXmlToBinary(*element, destination);
+        });
+
+        results.add({ "state", {}, {}, "save", "xml", numInstances, 0, saveXml });
+    }
+
+    //==============================================================================
+    juce::String toCSV(const juce::Array<BenchmarkResult>& results)
+    {
+        juce::String csv("benchmark,sample_type,filter_type,channels,block_size,parameters,variant,ns_per_sample\n");
+
+        for (const auto& r : results)
+            csv << r.benchmark << ',' << r.sampleType << ',' << r.filterType << ',' << r.numChannels << ','
+                << r.blockSize << ',' << r.parameters << ',' << r.variant << ',' << juce::String(r.nsPerSample, 4) << '\n';
+
+        return csv;
+    }
+
+    juce::String toJSON(const juce::Array<BenchmarkResult>& results)
+    {
+        juce::Array<juce::var> array;
+
+        for (const auto& r : results)
+        {
+            auto* object = new juce::DynamicObject();
+            object->setProperty("benchmark", r.benchmark);
+            object->setProperty("sample_type", r.sampleType);
+            object->setProperty("filter_type", r.filterType);
+            object->setProperty("channels", r.numChannels);
+            object->setProperty("block_size", r.blockSize);
+            object->setProperty("parameters", r.parameters);
+            object->setProperty("variant", r.variant);
+            object->setProperty("ns_per_sample", r.nsPerSample);
+            array.add(juce::var(object));
+        }
+
+        return juce::JSON::toString(juce::var(array));
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h"))
+    {
+        std::cout << "Usage: SVF1Bench [--format=csv|json] [--output=<file>] [--quick]" << std::endl
+                  << "                 [--filter-only | --bank-only | --processor-only | --state-only]" << std::endl
+                  << std::endl
+                  << "The bank benchmark also checks the bank's output against single filters," << std::endl
+                  << "and exits with 1 if they differ." << std::endl;
+        return 0;
+    }
+
+    BenchmarkOptions options;
+
+    if (args.containsOption("--quick"))
+        options.framesPerRun = 1 << 13;
+
+    juce::Array<BenchmarkResult> results;
+
+    const auto filterOnly = args.containsOption("--filter-only");
+    const auto bankOnly = args.containsOption("--bank-only");
+    const auto processorOnly = args.containsOption("--processor-only");
+    const auto stateOnly = args.containsOption("--state-only");
+    const auto runAll = ! filterOnly && ! bankOnly && ! processorOnly && ! stateOnly;
+
+    if (runAll || filterOnly)
+    {
+        benchmarkFilter<float>(options, "float", results);
+        benchmarkFilter<double>(options, "double", results);
+    }
+
+    auto bankMatches = true;
+
+    if (runAll || bankOnly)
+    {
+        bankMatches = benchmarkBank<float>(options, "float", results) && bankMatches;
+        bankMatches = benchmarkBank<double>(options, "double", results) && bankMatches;
+    }
+
+    if (runAll || processorOnly)
+    {
+        benchmarkProcessor<float>(options, "float", results);
+        benchmarkProcessor<double>(options, "double", results);
+    }
+
+    if (runAll || stateOnly)
+        benchmarkState(options, results);
+
+    const auto format = args.getValueForOption("--format");
+    const auto text = format == "json" ? toJSON(results) : toCSV(results);
+    const auto outputPath = args.getValueForOption("--output");
+
+    if (outputPath.isEmpty())
+    {
+        std::cout << text;
+        return bankMatches ? 0 : 1;
+    }
+
+    const auto outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(outputPath);
+
+    if (! outputFile.replaceWithText(text))
+    {
+        std::cerr << "Can't write " << outputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    return bankMatches ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+    BatchRender.cpp
+    Created: 17 Oct 2026 2:31:07pm
+    Author:  StoneyDSP
+
+  ==============================================================================
+*/
+
+#include "BatchRender.h"
+#include "../../Source/PluginProcessor.h"
+
+//==============================================================================
+juce::Result parseAutomationFile(const juce::File& file, juce::Array<ParameterEvent>& events)
+{
+    if (! file.existsAsFile())
+        return juce::Result::fail("Automation file not found: " + file.getFullPathName());
+
+    juce::StringArray lines;
+    file.readLines(lines);
+
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        const auto line = lines[i].upToFirstOccurrenceOf("#", false, false).trim();
+
+        if (line.isEmpty())
+            continue;
+
+        juce::StringArray tokens;
+        tokens.addTokens(line, " \t", {});
+        tokens.removeEmptyStrings();
+
+        if (tokens.size() != 3 || ! tokens[0].containsOnly("0123456789.eE+-"))
+            return juce::Result::fail(file.getFileName() + ":" + juce::String(i + 1)
+                                      + ": expected <time in seconds> <parameter id> <value>");
+
+        events.add({ tokens[0].getDoubleValue(), tokens[1], tokens[2].getFloatValue() });
+    }
+
+    std::stable_sort(events.begin(), events.end(),
+                     [](const ParameterEvent& a, const ParameterEvent& b) { return a.timeSeconds < b.timeSeconds; });
+
+    return juce::Result::ok();
+}
+
+//==============================================================================
+namespace
+{
+    void applyEvent(SVF1AudioProcessor& processor, const ParameterEvent& event)
+    {
+        if (auto* parameter = processor.apvts.getParameter(event.parameterID))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(event.value));
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> createWriter(juce::AudioFormat& format, const juce::File& file,
+                                                          const juce::AudioFormatReader& reader)
+    {
+        // Not every format takes every bit depth, float WAV into FLAC say.
+        for (auto bitsPerSample : { (int) reader.bitsPerSample, 24, 16 })
+        {
+            file.deleteFile();
+            std::unique_ptr<juce::FileOutputStream> stream(file.createOutputStream());
+
+            if (stream == nullptr)
+                return {};
+
+            std::unique_ptr<juce::AudioFormatWriter> writer(format.createWriterFor(stream.get(), reader.sampleRate,
+                                                                                   reader.numChannels, bitsPerSample,
+                                                                                   reader.metadataValues, 0));
+
+            if (writer != nullptr)
+            {
+                stream.release();   // now owned by the writer
+                return writer;
+            }
+        }
+
+        return {};
+    }
+}
+
+RenderResult renderFile(const juce::File& input, const RenderSettings& settings)
+{
+    RenderResult result;
+    result.input = input;
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+
+    if (reader == nullptr)
+    {
+        result.error = "Can't read " + input.getFullPathName();
+        return result;
+    }
+
+    const auto extension = settings.outputExtension.isNotEmpty() ? settings.outputExtension : input.getFileExtension();
+    auto* format = formatManager.findFormatForFileExtension(extension);
+
+    if (format == nullptr)
+    {
+        result.error = "No audio format for " + extension;
+        return result;
+    }
+
+    const auto directory = settings.outputDirectory != juce::File() ? settings.outputDirectory : input.getParentDirectory();
+    result.output = directory.getChildFile(input.getFileNameWithoutExtension() + "_svf1" + extension);
+
+    //==============================================================================
+    SVF1AudioProcessor processor;
+
+    const auto channelSet = juce::AudioChannelSet::canonicalChannelSet((int) reader->numChannels);
+    auto layout = processor.getBusesLayout();
+    layout.inputBuses.getReference(0) = channelSet;
+    layout.outputBuses.getReference(0) = channelSet;
+
+    for (int bus = 1; bus < layout.outputBuses.size(); ++bus)
+        layout.outputBuses.getReference(bus) = juce::AudioChannelSet::disabled();
+
+    if (! processor.setBusesLayout(layout))
+    {
+        result.error = "The plugin doesn't take " + juce::String(reader->numChannels) + " channels";
+        return result;
+    }
+
+    for (const auto& event : settings.automation)
+    {
+        if (processor.apvts.getParameter(event.parameterID) == nullptr)
+        {
+            result.error = "Unknown parameter: " + event.parameterID;
+            return result;
+        }
+    }
+
+    auto nextEvent = settings.automation.begin();
+
+    for (; nextEvent != settings.automation.end() && nextEvent->timeSeconds <= 0.0; ++nextEvent)
+        applyEvent(processor, *nextEvent);
+
+    processor.setNonRealtime(true);
+    processor.setRateAndBufferSizeDetails(reader->sampleRate, settings.blockSize);
+    processor.prepareToPlay(reader->sampleRate, settings.blockSize);
+
+    auto writer = createWriter(*format, result.output, *reader);
+
+    if (writer == nullptr)
+    {
+        result.error = "Can't write " + result.output.getFullPathName();
+        return result;
+    }
+
+    //==============================================================================
+    const auto numChannels = juce::jmax(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+    const auto length = reader->lengthInSamples;
+    juce::AudioBuffer<float> buffer(numChannels, settings.blockSize);
+    juce::MidiBuffer midi;
+
+    // The first latency samples out of the plugin come before the input, so
+    // they are dropped, and the input is padded with silence to flush the end.
+    auto samplesToSkip = (juce::int64) processor.getLatencySamples();
+    juce::int64 readPosition = 0, numWritten = 0;
+
+    while (numWritten < length)
+    {
+        // Every event in this block is scheduled for its own sample.
+        for (; nextEvent != settings.automation.end(); ++nextEvent)
+        {
+            const auto eventSample = (juce::int64) std::ceil(nextEvent->timeSeconds * reader->sampleRate);
+
+            if (eventSample >= readPosition + settings.blockSize)
+                break;
+
+            processor.scheduleParameterChange((int) juce::jmax((juce::int64) 0, eventSample - readPosition),
+                                              *processor.apvts.getParameter(nextEvent->parameterID), nextEvent->value);
+        }
+
+        buffer.clear();
+        reader->read(&buffer, 0, settings.blockSize, readPosition, true, true);
+        readPosition += settings.blockSize;
+
+        processor.processBlock(buffer, midi);
+
+        const auto skipped = (int) juce::jmin(samplesToSkip, (juce::int64) settings.blockSize);
+        const auto numToWrite = (int) juce::jmin((juce::int64) (settings.blockSize - skipped), length - numWritten);
+        samplesToSkip -= skipped;
+
+        if (numToWrite > 0 && ! writer->writeFromAudioSampleBuffer(buffer, skipped, numToWrite))
+        {
+            result.error = "Write failed: " + result.output.getFullPathName();
+            return result;
+        }
+
+        numWritten += numToWrite;
+    }
+
+    processor.releaseResources();
+
+    result.audioSeconds = (double) length / reader->sampleRate;
+    result.processSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    return result;
+}
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    BatchRender.h
+    Created: 17 Oct 2026 2:31:07pm
+    Author:  StoneyDSP
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/** A parameter value to apply while rendering, in the parameter's own units:
+    Hz for the cutoff, the index for a choice, 0 or 1 for a switch.
+*/
+struct ParameterEvent
+{
+    double timeSeconds = 0.0;
+    juce::String parameterID;
+    float value = 0.0f;
+};
+
+/** Reads an automation file, one "<time in seconds> <parameter id> <value>"
+    event per line, with # starting a comment. The events are sorted by time.
+*/
+juce::Result parseAutomationFile(const juce::File& file, juce::Array<ParameterEvent>& events);
+
+//==============================================================================
+/** How every file of a batch is rendered. */
+struct RenderSettings
+{
+    /** Where the rendered files go; next to each input when left empty. */
+    juce::File outputDirectory;
+
+    /** The extension of the format to write, such as ".wav" or ".flac"; the
+        format of each input when left empty.
+    */
+    juce::String outputExtension;
+
+    int blockSize = 512;
+
+    /** Parameter values, sorted by time. Events at time zero set up the plugin
+        before it is prepared, later ones land on the first sample at or after
+        their time, whatever the block size. The latency is taken once the plugin
+        is prepared, so automating the oversampling factor shifts what follows.
+    */
+    juce::Array<ParameterEvent> automation;
+};
+
+/** What happened to one file. */
+struct RenderResult
+{
+    juce::File input, output;
+    juce::String error;
+    double audioSeconds = 0.0, processSeconds = 0.0;
+
+    bool wasSuccessful() const noexcept { return error.isEmpty(); }
+};
+
+/** Streams one file through its own SVF1AudioProcessor in blocks of
+    settings.blockSize samples, and writes the result. The plugin's latency is
+    compensated, so the output lines up with the input and has the same length.
+    Safe to call from several threads at once.
+*/
+RenderResult renderFile(const juce::File& input, const RenderSettings& settings);
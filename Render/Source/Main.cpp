@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 2:31:07pm
+    Author:  StoneyDSP
+
+    Renders audio files through SVF1 offline, several at a time.
+
+  ==============================================================================
+*/
+
+#include <iostream>
+#include "BatchRender.h"
+#include "../../Source/PluginProcessor.h"
+
+//==============================================================================
+namespace
+{
+    void printUsage(const juce::StringArray& parameterIDs)
+    {
+        std::cout << "Usage: SVF1Render [options] <input files...>" << std::endl
+                  << std::endl
+                  << "  --output-dir=<dir>      where to write, next to each input by default" << std::endl
+                  << "  --format=<wav|aiff|flac> output format, that of each input by default" << std::endl
+                  << "  --block-size=<samples>  processing block size, 512 by default" << std::endl
+                  << "  --threads=<n>           files rendered at once, one per core by default" << std::endl
+                  << "  --automation=<file>     lines of <seconds> <parameter> <value>" << std::endl
+                  << "  --<parameter>=<value>   sets a parameter for the whole file, in its own" << std::endl
+                  << "                          units (Hz, index of a choice, 0 or 1)" << std::endl
+                  << std::endl
+                  << "Parameters: " << parameterIDs.joinIntoString(", ") << std::endl;
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    juce::StringArray parameterIDs;
+    {
+        SVF1AudioProcessor processor;
+
+        for (auto* parameter : processor.getParameters())
+            if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter))
+                parameterIDs.add(withID->paramID);
+    }
+
+    if (args.size() == 0 || args.containsOption("--help|-h"))
+    {
+        printUsage(parameterIDs);
+        return 0;
+    }
+
+    //==============================================================================
+    RenderSettings settings;
+    juce::Array<ParameterEvent> commandLineSettings;
+    juce::Array<juce::File> inputs;
+    auto numThreads = juce::SystemStats::getNumCpus();
+
+    for (const auto& arg : args.arguments)
+    {
+        if (! arg.isOption())
+        {
+            inputs.add(arg.resolveAsFile());
+            continue;
+        }
+
+        const auto option = arg.text.trimCharactersAtStart("-");
+        const auto name = option.upToFirstOccurrenceOf("=", false, false);
+        const auto value = option.fromFirstOccurrenceOf("=", false, false);
+
+        if (name == "output-dir")
+            settings.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+        else if (name == "format")
+            settings.outputExtension = "." + value.trimCharactersAtStart(".");
+        else if (name == "block-size")
+            settings.blockSize = juce::jmax(1, value.getIntValue());
+        else if (name == "threads")
+            numThreads = juce::jmax(1, value.getIntValue());
+        else if (name == "automation")
+        {
+            const auto parsed = parseAutomationFile(juce::File::getCurrentWorkingDirectory().getChildFile(value), settings.automation);
+
+            if (parsed.failed())
+            {
+                std::cerr << parsed.getErrorMessage() << std::endl;
+                return 1;
+            }
+        }
+        else if (parameterIDs.contains(name) && value.isNotEmpty())
+            commandLineSettings.add({ 0.0, name, value.getFloatValue() });
+        else
+        {
+            std::cerr << "Unknown option " << arg.text << std::endl;
+            printUsage(parameterIDs);
+            return 1;
+        }
+    }
+
+    // Settings from the command line go first, so the automation file can
+    // still change them at time zero.
+    settings.automation.insertArray(0, commandLineSettings.begin(), commandLineSettings.size());
+    std::stable_sort(settings.automation.begin(), settings.automation.end(),
+                     [](const ParameterEvent& a, const ParameterEvent& b) { return a.timeSeconds < b.timeSeconds; });
+
+    if (settings.outputDirectory != juce::File())
+        settings.outputDirectory.createDirectory();
+
+    //==============================================================================
+    juce::Array<RenderResult> results;
+    results.resize(inputs.size());
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    {
+        juce::ThreadPool pool(juce::jmin(numThreads, juce::jmax(1, inputs.size())));
+
+        for (int i = 0; i < inputs.size(); ++i)
+        {
+            pool.addJob([&results, &inputs, &settings, i]
+            {
+                results.getReference(i) = renderFile(inputs.getReference(i), settings);
+                return juce::ThreadPoolJob::jobHasFinished;
+            });
+        }
+
+        while (pool.getNumJobs() > 0)
+            juce::Thread::sleep(10);
+    }
+
+    const auto wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+    //==============================================================================
+    double audioSeconds = 0.0, processSeconds = 0.0;
+    int numFailed = 0;
+
+    for (const auto& result : results)
+    {
+        if (! result.wasSuccessful())
+        {
+            std::cerr << result.input.getFileName() << ": " << result.error << std::endl;
+            ++numFailed;
+            continue;
+        }
+
+        std::cout << result.input.getFileName() << " -> " << result.output.getFileName() << ": "
+                  << juce::String(result.audioSeconds, 2) << " s in " << juce::String(result.processSeconds, 3) << " s ("
+                  << juce::String(result.audioSeconds / juce::jmax(1.0e-9, result.processSeconds), 1) << "x realtime)" << std::endl;
+
+        audioSeconds += result.audioSeconds;
+        processSeconds += result.processSeconds;
+    }
+
+    std::cout << std::endl
+              << results.size() - numFailed << " of " << results.size() << " files, "
+              << juce::String(audioSeconds, 2) << " s of audio in " << juce::String(wallSeconds, 3) << " s" << std::endl
+              << juce::String(audioSeconds / juce::jmax(1.0e-9, processSeconds), 1) << "x realtime per core, "
+              << juce::String(audioSeconds / juce::jmax(1.0e-9, wallSeconds), 1) << "x overall" << std::endl;
+
+    return numFailed > 0 ? 1 : 0;
+}
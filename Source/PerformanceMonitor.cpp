@@ -0,0 +1,201 @@
+/*
+  ==============================================================================
+
+    PerformanceMonitor.cpp
+    Created: 17 Oct 2026 5:48:19pm
+    Author:  StoneyDSP
+
+  ==============================================================================
+*/
+
+#include "PerformanceMonitor.h"
+
+//==============================================================================
+juce::String PerformanceMonitor::Statistics::toString() const
+{
+    auto format = [](const char* name, const StageStatistics& s, const char* unit)
+    {
+        return juce::String(name) + " " + juce::String(s.p50, 1) + " / " + juce::String(s.p99, 1)
+               + " / " + juce::String(s.max, 1) + unit;
+    };
+
+    return format("load", load, "%") + ", "
+           + format("total", total, " us") + ", "
+           + format("update", stages[update], " us") + ", "
+           + format("split", stages[split], " us") + ", "
+           + format("filter", stages[filter], " us")
+           + " (p50 / p99 / max of " + juce::String(numBlocks) + " blocks, " + juce::String(numDropped) + " dropped)";
+}
+
+//==============================================================================
+PerformanceMonitor::PerformanceMonitor()
+{
+    window.reserve(windowSize);
+    scratch.reserve(windowSize);
+
+    calibrationCycles = now();
+    calibrationTicks = juce::Time::getHighResolutionTicks();
+}
+
+PerformanceMonitor::~PerformanceMonitor()
+{
+    cancelPendingUpdate();
+    stopTimer();
+}
+
+void PerformanceMonitor::addUser()
+{
+    ++numUsers;
+    updateTimer();
+}
+
+void PerformanceMonitor::removeUser()
+{
+    jassert(numUsers.load() > 0);
+
+    --numUsers;
+    updateTimer();
+}
+
+void PerformanceMonitor::setLoggingEnabled(bool shouldLog)
+{
+    loggingEnabled = shouldLog;
+
+    // Timers belong to the message thread.
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        updateTimer();
+    else
+        triggerAsyncUpdate();
+}
+
+void PerformanceMonitor::handleAsyncUpdate()
+{
+    updateTimer();
+}
+
+void PerformanceMonitor::updateTimer()
+{
+    if (isEnabled())
+    {
+        if (! isTimerRunning())
+            startTimerHz(10);
+    }
+    else
+    {
+        stopTimer();
+    }
+}
+
+//==============================================================================
+void PerformanceMonitor::push(const BlockRecord& record) noexcept
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 + size2 < 1)
+    {
+        ++numDropped;
+        return;
+    }
+
+    fifoRecords[(size_t) (size1 > 0 ? start1 : start2)] = record;
+    fifo.finishedWrite(1);
+}
+
+void PerformanceMonitor::timerCallback()
+{
+    // The cycle counter runs at a rate of its own, so keep measuring it against
+    // the high resolution clock; the estimate only improves with time.
+    const auto ticks = juce::Time::getHighResolutionTicks();
+    const auto elapsed = juce::Time::highResolutionTicksToSeconds(ticks - calibrationTicks);
+
+    if (elapsed > 0.05)
+        cyclesPerSecond = (double) (now() - calibrationCycles) / elapsed;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+
+    for (auto range : { std::make_pair(start1, size1), std::make_pair(start2, size2) })
+    {
+        for (int i = 0; i < range.second; ++i)
+        {
+            const auto& record = fifoRecords[(size_t) (range.first + i)];
+
+            if (window.size() < windowSize)
+                window.push_back(record);
+            else
+                window[nextWindowIndex] = record;
+
+            nextWindowIndex = (nextWindowIndex + 1) % windowSize;
+        }
+    }
+
+    fifo.finishedRead(size1 + size2);
+
+    if (window.empty() || cyclesPerSecond <= 0.0)
+        return;
+
+    //==============================================================================
+    const auto microsecondsPerCycle = 1.0e6 / cyclesPerSecond;
+
+    auto collect = [this, microsecondsPerCycle](auto&& getCycles)
+    {
+        scratch.clear();
+
+        for (const auto& record : window)
+            scratch.push_back((double) getCycles(record) * microsecondsPerCycle);
+
+        return calculateStatistics(scratch);
+    };
+
+    for (size_t stage = 0; stage < numStages; ++stage)
+    {
+        statistics.stages[stage] = collect([stage](const BlockRecord& r)
+        {
+            return r.stageEnds[stage] - (stage == 0 ? r.start : r.stageEnds[stage - 1]);
+        });
+    }
+
+    statistics.total = collect([](const BlockRecord& r) { return r.stageEnds.back() - r.start; });
+
+    const auto rate = sampleRate.load();
+
+    scratch.clear();
+
+    for (const auto& record : window)
+    {
+        const auto blockMicroseconds = 1.0e6 * record.numSamples / rate;
+        const auto microseconds = (double) (record.stageEnds.back() - record.start) * microsecondsPerCycle;
+        scratch.push_back(blockMicroseconds > 0.0 ? 100.0 * microseconds / blockMicroseconds : 0.0);
+    }
+
+    statistics.load = calculateStatistics(scratch);
+    statistics.numBlocks = (int) window.size();
+    statistics.numDropped = numDropped.load();
+
+    if (loggingEnabled.load() && juce::Time::highResolutionTicksToSeconds(ticks - lastLogTicks) >= 1.0)
+    {
+        lastLogTicks = ticks;
+        juce::Logger::writeToLog("SVF1 " + statistics.toString());
+    }
+}
+
+PerformanceMonitor::StageStatistics PerformanceMonitor::calculateStatistics(std::vector<double>& values) const
+{
+    StageStatistics result;
+
+    if (values.empty())
+        return result;
+
+    auto percentile = [&values](double proportion)
+    {
+        const auto index = (size_t) (proportion * (double) (values.size() - 1));
+        std::nth_element(values.begin(), values.begin() + (std::ptrdiff_t) index, values.end());
+        return values[index];
+    };
+
+    result.p50 = percentile(0.5);
+    result.p99 = percentile(0.99);
+    result.max = *std::max_element(values.begin(), values.end());
+    return result;
+}
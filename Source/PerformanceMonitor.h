@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+
+    PerformanceMonitor.h
+    Created: 17 Oct 2026 5:48:19pm
+    Author:  StoneyDSP
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#if JUCE_INTEL && JUCE_MSVC
+ #include <intrin.h>
+#elif JUCE_INTEL
+ #include <x86intrin.h>
+#endif
+
+//==============================================================================
+/** Measures how long each block spends in the stages of the plugin's
+    processBlock, and how much of the block's duration that is.
+
+    The audio thread timestamps each stage with the CPU's cycle counter, through
+    a BlockTimer, and pushes one record per block into a wait-free single
+    producer, single consumer FIFO. It never allocates or locks, and does nothing
+    at all unless the monitor is enabled. A timer on the message thread drains
+    the FIFO into a window of the most recent blocks and computes the median,
+    99th percentile and maximum of each stage.
+
+    The monitor is enabled while an editor uses it (see addUser()) or while
+    logging is on, in which case the statistics are written to the juce::Logger
+    once a second. Both need a running message loop, as in a host or the
+    standalone app; the console tools have none, so they never log.
+*/
+class PerformanceMonitor  : private juce::Timer,
+                            private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    /** The timed stages of a block, in the order they run. */
+    enum Stage
+    {
+        update,
+        split,
+        filter,
+        numStages
+    };
+
+    /** Timestamps of one block, in cycles. */
+    struct BlockRecord
+    {
+        juce::int64 start = 0;
+        std::array<juce::int64, numStages> stageEnds {};
+        int numSamples = 0;
+    };
+
+    /** Times in microseconds. */
+    struct StageStatistics
+    {
+        double p50 = 0.0, p99 = 0.0, max = 0.0;
+    };
+
+    struct Statistics
+    {
+        std::array<StageStatistics, numStages> stages;
+        StageStatistics total;
+
+        /** The time taken as a percentage of the block's duration. */
+        StageStatistics load;
+
+        int numBlocks = 0, numDropped = 0;
+
+        juce::String toString() const;
+    };
+
+    //==============================================================================
+    PerformanceMonitor();
+    ~PerformanceMonitor() override;
+
+    /** Sets the sample rate used to turn block sizes into durations. */
+    void prepare(double newSampleRate) noexcept { sampleRate = newSampleRate; }
+
+    /** True while anything is reading the statistics. */
+    bool isEnabled() const noexcept { return numUsers.load() > 0 || loggingEnabled.load(); }
+
+    /** Enables the monitor for one more reader, such as an open editor. Call
+        removeUser() when done. Message thread only.
+    */
+    void addUser();
+    void removeUser();
+
+    /** Writes the statistics to the juce::Logger once a second. Any thread: off
+        the message thread, such as in a plugin constructor that the host runs
+        elsewhere, the timer starts once the message loop gets to it.
+    */
+    void setLoggingEnabled(bool shouldLog);
+
+    /** Returns the statistics of the most recent blocks. Message thread only. */
+    const Statistics& getStatistics() const noexcept { return statistics; }
+
+    //==============================================================================
+    /** Returns a timestamp in cycles, or in high resolution ticks where there is
+        no cycle counter to read.
+    */
+    static juce::int64 now() noexcept
+    {
+       #if JUCE_INTEL
+        return (juce::int64) __rdtsc();
+       #else
+        return juce::Time::getHighResolutionTicks();
+       #endif
+    }
+
+    /** Hands one block's timestamps to the message thread. Never blocks; the
+        record is dropped if the FIFO is full. Audio thread only.
+    */
+    void push(const BlockRecord& record) noexcept;
+
+    //==============================================================================
+    /** Timestamps one block on the audio thread and pushes the record when it
+        goes out of scope. Stages that don't run, when bypassed say, take no time.
+    */
+    class BlockTimer
+    {
+    public:
+        BlockTimer(PerformanceMonitor& monitorToUse, int numSamples) noexcept
+            : monitor(monitorToUse), enabled(monitorToUse.isEnabled())
+        {
+            if (enabled)
+            {
+                record.numSamples = numSamples;
+                record.start = now();
+            }
+        }
+
+        ~BlockTimer()
+        {
+            if (! enabled)
+                return;
+
+            auto last = record.start;
+
+            for (auto& end : record.stageEnds)
+                last = end = juce::jmax(end, last);
+
+            monitor.push(record);
+        }
+
+        /** Marks the end of a stage. */
+        void mark(Stage stage) noexcept
+        {
+            if (enabled)
+                record.stageEnds[(size_t) stage] = now();
+        }
+
+    private:
+        PerformanceMonitor& monitor;
+        const bool enabled;
+        BlockRecord record;
+
+        JUCE_DECLARE_NON_COPYABLE (BlockTimer)
+    };
+
+private:
+    //==============================================================================
+    void timerCallback() override;
+    void handleAsyncUpdate() override;
+    void updateTimer();
+    StageStatistics calculateStatistics(std::vector<double>& values) const;
+
+    //==============================================================================
+    static constexpr int fifoSize = 1024;
+    static constexpr size_t windowSize = 4096;
+
+    juce::AbstractFifo fifo { fifoSize };
+    std::array<BlockRecord, fifoSize> fifoRecords;
+    std::atomic<int> numDropped { 0 };
+
+    /** The most recent windowSize blocks, overwritten in a circle. */
+    std::vector<BlockRecord> window;
+    size_t nextWindowIndex = 0;
+    std::vector<double> scratch;
+
+    std::atomic<int> numUsers { 0 };
+    std::atomic<bool> loggingEnabled { false };
+    std::atomic<double> sampleRate { 44100.0 };
+
+    /** The cycle counter's rate, measured against the high resolution clock. */
+    juce::int64 calibrationCycles = 0, calibrationTicks = 0;
+    double cyclesPerSecond = 0.0;
+
+    Statistics statistics;
+    juce::int64 lastLogTicks = 0;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PerformanceMonitor)
+};
@@ -9,13 +9,74 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+//==============================================================================
+FrequencyResponseComponent::FrequencyResponseComponent(SVF1AudioProcessor& processor)
+    : audioProcessor(processor)
+{
+    setInterceptsMouseClicks(false, false);
+
+    for (int point = 0; point < SpectrumAnalyser::numPoints; ++point)
+        frequencies[(size_t) point] = (double) SpectrumAnalyser::getPointFrequency(point);
+
+    path.preallocateSpace(SpectrumAnalyser::numPoints * 3);
+    startTimerHz(30);
+}
+
+void FrequencyResponseComponent::timerCallback()
+{
+    const auto newResponse = audioProcessor.getFilterResponse();
+
+    if (hasResponse && newResponse == response)
+        return;
+
+    response = newResponse;
+    hasResponse = true;
+    response.getMagnitudeAndPhase(frequencies.data(), magnitudes.data(), nullptr, frequencies.size());
+
+    updatePath();
+    repaint();
+}
+
+void FrequencyResponseComponent::resized()
+{
+    updatePath();
+}
+
+void FrequencyResponseComponent::updatePath()
+{
+    path.clear();
+
+    if (! hasResponse)
+        return;
+
+    const auto area = getLocalBounds().toFloat();
+
+    for (int point = 0; point < SpectrumAnalyser::numPoints; ++point)
+    {
+        const auto decibels = juce::Decibels::gainToDecibels((float) magnitudes[(size_t) point], minDecibels);
+        const auto x = area.getX() + area.getWidth() * (float) point / (float) (SpectrumAnalyser::numPoints - 1);
+        const auto y = juce::jmap(juce::jmin(decibels, maxDecibels), minDecibels, maxDecibels, area.getBottom(), area.getY());
+
+        if (point == 0)
+            path.startNewSubPath(x, y);
+        else
+            path.lineTo(x, y);
+    }
+}
+
+void FrequencyResponseComponent::paint(juce::Graphics& g)
+{
+    g.setColour(juce::Colours::white.withAlpha(0.8f));
+    g.strokePath(path, juce::PathStrokeType(2.0f));
+}
+
 //==============================================================================
 SVF1AudioProcessorEditor::SVF1AudioProcessorEditor (SVF1AudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p)
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize(400, 300);
+    setSize(400, 580);
 
     addAndMakeVisible(freqSlider);
     freqSlider.setSliderStyle(juce::Slider::LinearHorizontal);
@@ -25,27 +86,83 @@ SVF1AudioProcessorEditor::SVF1AudioProcessorEditor (SVF1AudioProcessor& p)
     resSlider.setSliderStyle(juce::Slider::LinearHorizontal);
     resSliderAttachmentPtr.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(audioProcessor.apvts, "resonance", resSlider));
 
-    addAndMakeVisible(typeBox);
-    typeBox.addItem("Lowpass 12dB", 1);
-    typeBox.addItem("Lowpass 6dB", 2);
-    typeBox.addItem("Lowpass 12dB (n)", 3);
-    typeBox.addItem("Highpass 12dB", 4);
-    typeBox.addItem("Highpass 6dB", 5);
-    typeBox.addItem("Highpass 12dB (n)", 6);
-    typeBox.addItem("Bandpass 12dB", 7);
-    typeBox.addItem("Bandpass 12dB (n)", 8);
-    typeBox.addItem("Allpass 12dB", 9);
-    typeBox.addItem("Peak 12dB", 10);
-    typeBox.addItem("Notch 12dB", 11);
+    // The type and the type it morphs to share the same list.
+    for (auto* box : { &typeBox, &morphTypeBox })
+    {
+        addAndMakeVisible(*box);
+        box->addItem("Lowpass 12dB", 1);
+        box->addItem("Lowpass 6dB", 2);
+        box->addItem("Lowpass 12dB (n)", 3);
+        box->addItem("Highpass 12dB", 4);
+        box->addItem("Highpass 6dB", 5);
+        box->addItem("Highpass 12dB (n)", 6);
+        box->addItem("Bandpass 12dB", 7);
+        box->addItem("Bandpass 12dB (n)", 8);
+        box->addItem("Allpass 12dB", 9);
+        box->addItem("Peak 12dB", 10);
+        box->addItem("Notch 12dB", 11);
+    }
+
     typeBoxAttachmentPtr.reset(new juce::AudioProcessorValueTreeState::ComboBoxAttachment(audioProcessor.apvts, "type", typeBox));
+    morphTypeBoxAttachmentPtr.reset(new juce::AudioProcessorValueTreeState::ComboBoxAttachment(audioProcessor.apvts, "morphType", morphTypeBox));
+
+    addAndMakeVisible(slopeBox);
+    slopeBox.addItem("12 dB/oct", 1);
+    slopeBox.addItem("24 dB/oct", 2);
+    slopeBox.addItem("36 dB/oct", 3);
+    slopeBox.addItem("48 dB/oct", 4);
+    slopeBoxAttachmentPtr.reset(new juce::AudioProcessorValueTreeState::ComboBoxAttachment(audioProcessor.apvts, "slope", slopeBox));
+
+    addAndMakeVisible(oversamplingBox);
+    oversamplingBox.addItem("1x", 1);
+    oversamplingBox.addItem("2x", 2);
+    oversamplingBox.addItem("4x", 3);
+    oversamplingBox.addItem("8x", 4);
+    oversamplingBoxAttachmentPtr.reset(new juce::AudioProcessorValueTreeState::ComboBoxAttachment(audioProcessor.apvts, "oversampling", oversamplingBox));
 
     addAndMakeVisible(mixSlider);
     mixSlider.setSliderStyle(juce::Slider::LinearHorizontal);
     mixSliderAttachmentPtr.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(audioProcessor.apvts, "mix", mixSlider));
+
+    addAndMakeVisible(morphSlider);
+    morphSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    morphSliderAttachmentPtr.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(audioProcessor.apvts, "morph", morphSlider));
+
+    addAndMakeVisible(driveSlider);
+    driveSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    driveSliderAttachmentPtr.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(audioProcessor.apvts, "drive", driveSlider));
+
+    addAndMakeVisible(performanceLabel);
+    performanceLabel.setFont(juce::Font(12.0f));
+    performanceLabel.setJustificationType(juce::Justification::centredLeft);
+
+    // The analyser only runs while this is showing it.
+    addAndMakeVisible(spectrumAnalyser);
+    addAndMakeVisible(frequencyResponse);
+
+    // The processor only times its blocks while someone is looking.
+    audioProcessor.getPerformanceMonitor().addUser();
+    startTimerHz(4);
 }
 
 SVF1AudioProcessorEditor::~SVF1AudioProcessorEditor()
 {
+    stopTimer();
+    audioProcessor.getPerformanceMonitor().removeUser();
+}
+
+void SVF1AudioProcessorEditor::timerCallback()
+{
+    const auto& statistics = audioProcessor.getPerformanceMonitor().getStatistics();
+
+    if (statistics.numBlocks == 0)
+        return;
+
+    performanceLabel.setText("CPU " + juce::String(statistics.load.p50, 1) + "% / "
+                             + juce::String(statistics.load.p99, 1) + "% / "
+                             + juce::String(statistics.load.max, 1) + "% (p50 / p99 / max), filter p99 "
+                             + juce::String(statistics.stages[PerformanceMonitor::filter].p99, 1) + " us",
+                             juce::dontSendNotification);
 }
 
 //==============================================================================
@@ -67,5 +184,13 @@ void SVF1AudioProcessorEditor::resized()
     freqSlider.setBounds(50, 50, 350, 50);
     resSlider.setBounds(50, 100, 350, 50);
     typeBox.setBounds(50, 170, 200, 22);
+    morphTypeBox.setBounds(50, 198, 200, 22);
+    slopeBox.setBounds(260, 170, 130, 22);
+    oversamplingBox.setBounds(260, 198, 130, 22);
     mixSlider.setBounds(50, 230, 350, 50);
+    morphSlider.setBounds(50, 280, 350, 50);
+    driveSlider.setBounds(50, 330, 350, 50);
+    performanceLabel.setBounds(50, 390, 340, 24);
+    spectrumAnalyser.setBounds(10, 422, 380, 148);
+    frequencyResponse.setBounds(spectrumAnalyser.getBounds());
 }
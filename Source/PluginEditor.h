@@ -11,10 +11,42 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 
+//==============================================================================
+/** Draws the magnitude response of the filter, on the same frequency axis as
+    the spectrum analyser. The curve is cached, and worked out again only when
+    the coefficients change.
+*/
+class FrequencyResponseComponent  : public juce::Component,
+                                    private juce::Timer
+{
+public:
+    explicit FrequencyResponseComponent(SVF1AudioProcessor& processor);
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    void timerCallback() override;
+    void updatePath();
+
+    static constexpr float minDecibels = -48.0f, maxDecibels = 24.0f;
+
+    SVF1AudioProcessor& audioProcessor;
+
+    StateVariableTPTFilterResponse response;
+    bool hasResponse = false;
+
+    std::array<double, SpectrumAnalyser::numPoints> frequencies, magnitudes;
+    juce::Path path;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FrequencyResponseComponent)
+};
+
 //==============================================================================
 /**
 */
-class SVF1AudioProcessorEditor  : public juce::AudioProcessorEditor
+class SVF1AudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                  private juce::Timer
 {
 public:
     SVF1AudioProcessorEditor (SVF1AudioProcessor&);
@@ -25,6 +57,9 @@ public:
     void resized() override;
 
 private:
+    /** Shows the latest processBlock timings. */
+    void timerCallback() override;
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     SVF1AudioProcessor& audioProcessor;
@@ -38,8 +73,28 @@ private:
     juce::ComboBox typeBox;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> typeBoxAttachmentPtr;
 
+    juce::ComboBox morphTypeBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> morphTypeBoxAttachmentPtr;
+
+    juce::Slider morphSlider;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> morphSliderAttachmentPtr;
+
+    juce::ComboBox slopeBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> slopeBoxAttachmentPtr;
+
+    juce::ComboBox oversamplingBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> oversamplingBoxAttachmentPtr;
+
     juce::Slider mixSlider;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> mixSliderAttachmentPtr;
 
+    juce::Slider driveSlider;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> driveSliderAttachmentPtr;
+
+    juce::Label performanceLabel;
+
+    SpectrumAnalyserComponent spectrumAnalyser { audioProcessor.getSpectrumAnalyser() };
+    FrequencyResponseComponent frequencyResponse { audioProcessor };
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SVF1AudioProcessorEditor)
 };
@@ -13,7 +13,10 @@
 SVF1AudioProcessor::SVF1AudioProcessor()
      : AudioProcessor (BusesProperties()
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
-                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true))
+                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                       .withOutput ("Low",    juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("Band",   juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("High",   juce::AudioChannelSet::stereo(), false))
 {
     cutoff = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("cutoff"));
     jassert(cutoff != nullptr);
@@ -24,15 +27,62 @@ SVF1AudioProcessor::SVF1AudioProcessor()
     type = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("type"));
     jassert(type != nullptr);
 
+    slope = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("slope"));
+    jassert(slope != nullptr);
+
     mix = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("mix"));
     jassert(mix != nullptr);
 
+    oversampling = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("oversampling"));
+    jassert(oversampling != nullptr);
+
     bypass = dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter("bypass"));
     jassert(bypass != nullptr);
+
+    morph = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("morph"));
+    jassert(morph != nullptr);
+
+    morphType = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("morphType"));
+    jassert(morphType != nullptr);
+
+    drive = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("drive"));
+    jassert(drive != nullptr);
+
+    for (auto* parameterID : { "cutoff", "resonance", "type", "slope", "mix", "oversampling", "bypass", "morph", "morphType", "drive" })
+        apvts.addParameterListener(parameterID, this);
+
+    // The whole cutoff range sits below 0.46 * fs even at 44.1 kHz, where the
+    // fast coefficients are well inside float precision.
+    forEachFilter([](auto& f) { f.setCoefficientMode(StateVariableTPTFilterCoefficientMode::fast); });
+    responseFilter.setCoefficientMode(StateVariableTPTFilterCoefficientMode::fast);
+
+    // Glide between the per-block parameter values instead of stepping to them,
+    // over the same time the dry/wet mix used to be ramped.
+    forEachFilter([](auto& f) { f.setRampDurationSeconds(0.05); });
+
+    if (juce::SystemStats::getEnvironmentVariable("SVF1_PERFORMANCE_LOG", {}).isNotEmpty())
+        performanceMonitor.setLoggingEnabled(true);
 }
 
 SVF1AudioProcessor::~SVF1AudioProcessor()
 {
+    cancelPendingUpdate();
+
+    for (auto* parameterID : { "cutoff", "resonance", "type", "slope", "mix", "oversampling", "bypass", "morph", "morphType", "drive" })
+        apvts.removeParameterListener(parameterID, this);
+}
+
+//==============================================================================
+template <>
+SVF1AudioProcessor::FilterSet<float>& SVF1AudioProcessor::getFilterSet<float>() noexcept
+{
+    return floatFilters;
+}
+
+template <>
+SVF1AudioProcessor::FilterSet<double>& SVF1AudioProcessor::getFilterSet<double>() noexcept
+{
+    return doubleFilters;
 }
 
 //==============================================================================
@@ -70,7 +120,7 @@ bool SVF1AudioProcessor::isMidiEffect() const
 
 double SVF1AudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailLengthSeconds.load();
 }
 
 int SVF1AudioProcessor::getNumPrograms()
@@ -109,23 +159,109 @@ void SVF1AudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 
     spec.sampleRate = sampleRate;
     spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = getTotalNumOutputChannels();
+    spec.numChannels = (juce::uint32) getMainBusNumOutputChannels();
+
+    // Waiting on worker threads has no place in real time, but offline a wide
+    // bus is otherwise bound by a single core. processSubBlock() picks between
+    // the two on every block.
+    canUseParallelFilter = spec.numChannels >= minNumParallelChannels;
+    useParallelFilter = canUseParallelFilter && isNonRealtime();
+
+    performanceMonitor.prepare(sampleRate);
+    spectrumAnalyser.prepare(sampleRate);
 
+    markAllParametersChanged();
     update();
     prepare();
     reset();
+
+    // Again, now that the filters run at the new rate.
+    updateTailLength();
 }
 
 void SVF1AudioProcessor::prepare()
 {
-    filter.prepare(spec);
-    mixer.prepare(spec);
+    // The set for the other precision doesn't run until the host switches and
+    // prepares again, so its oversamplers needn't hold on to their buffers.
+    for (auto& oversampler : floatFilters.oversamplers)
+        oversampler.reset();
+
+    for (auto& oversampler : doubleFilters.oversamplers)
+        oversampler.reset();
+
+    forActiveFilterSet([this](auto& filters) { prepareFilterSet(filters); });
+}
+
+template <typename SampleType>
+void SVF1AudioProcessor::prepareFilterSet(FilterSet<SampleType>& filters)
+{
+    for (size_t i = 0; i < filters.oversamplers.size(); ++i)
+    {
+        filters.oversamplers[i] = std::make_unique<juce::dsp::Oversampling<SampleType>>(spec.numChannels, i + 1,
+                                                                                         juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR,
+                                                                                         true, true);
+        filters.oversamplers[i]->initProcessing(spec.maximumBlockSize);
+    }
+
+    // Each factor reports its own latency, so 1x adds none, and the host is
+    // told of a new factor's from the message thread. The padding is sized for
+    // the highest, so that switching never allocates.
+    oversamplingLatencies[0] = 0;
+
+    for (size_t i = 0; i < filters.oversamplers.size(); ++i)
+        oversamplingLatencies[i + 1] = juce::roundToInt(filters.oversamplers[i]->getLatencyInSamples());
+
+    const auto maxLatencySamples = oversamplingLatencies.back();
+    filters.latencyPadding.setMaximumDelayInSamples(maxLatencySamples);
+    filters.latencyPadding.prepare(spec);
+
+    for (auto& padding : filters.splitLatencyPadding)
+    {
+        padding.setMaximumDelayInSamples(maxLatencySamples);
+        padding.prepare(spec);
+    }
+
+    prepareFilters();
+    setLatencySamples(latencySamples);
+    filters.splitFilter.prepare(spec);
+}
+
+void SVF1AudioProcessor::prepareFilters()
+{
+    const auto factor = (juce::uint32) 1 << oversamplingIndex;
+
+    auto filterSpec = spec;
+    filterSpec.sampleRate *= factor;
+    filterSpec.maximumBlockSize *= factor;
+
+    forActiveFilter([&filterSpec](auto& f) { f.prepare(filterSpec); });
+
+    latencySamples = oversamplingLatencies[oversamplingIndex];
+
+    forActiveFilterSet([this](auto& filters)
+    {
+        for (auto& padding : filters.splitLatencyPadding)
+            padding.setDelay(static_cast<SampleType> (latencySamples));
+    });
 }
 
 void SVF1AudioProcessor::reset()
 {
-    filter.reset();
-    mixer.reset();
+    idle = false;
+
+    forActiveFilterSet([this](auto& filters)
+    {
+        forActiveFilter(filters, [](auto& f) { f.reset(); });
+        filters.splitFilter.reset();
+        filters.latencyPadding.reset();
+
+        for (auto& padding : filters.splitLatencyPadding)
+            padding.reset();
+
+        for (auto& oversampler : filters.oversamplers)
+            if (oversampler != nullptr)
+                oversampler->reset();
+    });
 }
 
 void SVF1AudioProcessor::releaseResources()
@@ -141,10 +277,19 @@ bool SVF1AudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) cons
         || layouts.getMainOutputChannelSet() == juce::AudioChannelSet::disabled())
         return false;
 
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-        && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout, discrete, surround or ambisonic: the channels share one set
+    // of coefficients and are processed as SIMD lanes, so a wide bus costs
+    // little more per channel than a stereo one.
+    if (layouts.getMainInputChannelSet().size() > maxNumChannels
+        || layouts.getMainOutputChannelSet().size() > maxNumChannels)
         return false;
 
+    // The optional Low/Band/High split buses must match the main output.
+    for (int bus = 1; bus < layouts.outputBuses.size(); ++bus)
+        if (! layouts.getChannelSet(false, bus).isDisabled()
+            && layouts.getChannelSet(false, bus) != layouts.getMainOutputChannelSet())
+            return false;
+
     return true;
 }
 #endif
@@ -152,7 +297,31 @@ bool SVF1AudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) cons
 void SVF1AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ignoreUnused(midiMessages);
+    processBuffer(buffer);
+}
+
+void SVF1AudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    processBuffer(buffer);
+}
+
+bool SVF1AudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+template <typename SampleType>
+void SVF1AudioProcessor::processBuffer(juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+    // Hosts only call the overload for the precision they prepared with.
+    jassert(isUsingDoublePrecision() == std::is_same<SampleType, double>::value);
+
     juce::ScopedNoDenormals noDenormals;
+
+    // Offline, the parallel filter waits for its workers, and that's fine.
+    const RealtimeSafety::ScopedRealtimeSection realtimeSection(! isNonRealtime());
+
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -165,19 +334,243 @@ void SVF1AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::M
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    
-    update();
+    PerformanceMonitor::BlockTimer timer(performanceMonitor, buffer.getNumSamples());
+    const auto block = juce::dsp::AudioBlock<SampleType>(buffer);
+
+    // Only a copy into a FIFO, and only while an editor shows the spectra.
+    spectrumAnalyser.push<SampleType>(SpectrumAnalyser::input, block.getSubsetChannelBlock(0, (size_t) juce::jmin(totalNumInputChannels, getMainBusNumInputChannels())));
+
+    // Nothing scheduled, the usual case: the whole block in one go.
+    if (numScheduledChanges == 0)
+    {
+        update();
+        timer.mark(PerformanceMonitor::update);
+
+        processSubBlock(block, timer);
+    }
+    else
+    {
+        processScheduledChanges(block, timer);
+    }
+
+    spectrumAnalyser.push<SampleType>(SpectrumAnalyser::output, block.getSubsetChannelBlock(0, (size_t) getMainBusNumOutputChannels()));
+}
+
+void SVF1AudioProcessor::scheduleParameterChange(int sampleOffset, juce::RangedAudioParameter& parameter, float value) noexcept
+{
+    // Offsets before the block land on its first sample.
+    sampleOffset = juce::jmax(0, sampleOffset);
+
+    if (numScheduledChanges == scheduledChanges.size())
+    {
+        // Too many for one block; this one lands now rather than not at all.
+        jassertfalse;
+        applyParameterValue(parameter, parameter.convertFrom0to1(parameter.convertTo0to1(value)));
+        return;
+    }
+
+    // Kept in order of offset, and in the order they were scheduled at the same
+    // offset, so that the last change to a parameter wins.
+    const auto begin = scheduledChanges.begin();
+    const auto end = begin + (std::ptrdiff_t) numScheduledChanges;
+    const auto position = std::upper_bound(begin, end, sampleOffset,
+                                           [](int offset, const ScheduledChange& change) { return offset < change.sampleOffset; });
+
+    std::move_backward(position, end, end + 1);
+    *position = { sampleOffset, &parameter, value };
+    ++numScheduledChanges;
+}
+
+template <typename SampleType>
+void SVF1AudioProcessor::processScheduledChanges(const juce::dsp::AudioBlock<SampleType>& block, PerformanceMonitor::BlockTimer& timer) noexcept
+{
+    const auto numSamples = (int) block.getNumSamples();
+    size_t next = 0;
+
+    // Straight to the DSP, as update() passes them on, and rounded to values
+    // the parameter could take. The parameters themselves, and so the host,
+    // never see these changes.
+    auto applyChangesUpTo = [this, &next](int offset)
+    {
+        for (; next < numScheduledChanges && scheduledChanges[next].sampleOffset <= offset; ++next)
+        {
+            auto& change = scheduledChanges[next];
+            applyParameterValue(*change.parameter, change.parameter->convertFrom0to1(change.parameter->convertTo0to1(change.value)));
+        }
+    };
+
+    // Each sub-block runs from one change to the next, and starts with the
+    // filter updated, so every change starts on its own sample. From there it
+    // ramps over the filters' ramp time like any other change. The timer's
+    // stages are those of the last sub-block.
+    for (int start = 0; start < numSamples;)
+    {
+        applyChangesUpTo(start);
+
+        const auto end = next < numScheduledChanges ? juce::jmin(scheduledChanges[next].sampleOffset, numSamples) : numSamples;
+
+        update();
+        timer.mark(PerformanceMonitor::update);
+
+        processSubBlock(block.getSubBlock((size_t) start, (size_t) (end - start)), timer);
+        start = end;
+    }
+
+    // Changes past the end of the block land at the start of the next one.
+    applyChangesUpTo(std::numeric_limits<int>::max());
+    numScheduledChanges = 0;
+
+    updateTailLength();
+}
+
+template <typename SampleType>
+void SVF1AudioProcessor::processSubBlock(const juce::dsp::AudioBlock<SampleType>& block, PerformanceMonitor::BlockTimer& timer) noexcept
+{
+    auto& filters = getFilterSet<SampleType>();
+
+    // The buffer can carry more input channels than the filter was prepared for.
+    auto mainBlock = block.getSubsetChannelBlock(0, spec.numChannels);
+
+    // Bypassed, the input is still delayed by the latency the host compensates
+    // for, so that bypassing doesn't move it.
+    if (bypassed)
+    {
+        padLatency(filters, mainBlock);
+        return;
+    }
+
+    updateParallelFilter(filters);
+
+    // Silent input through filters that have rung out gives silent output, so
+    // there is nothing to compute until the input comes back.
+    const auto inputIsSilent = isInputSilent(block);
+
+    if (inputIsSilent && idle)
+    {
+        block.clear();
+        return;
+    }
+
+    idle = false;
+
+    processSplitBuses(block);
+    timer.mark(PerformanceMonitor::split);
+
+    // The filter mixes the dry signal back in as it goes, so with oversampling
+    // the dry signal goes through the same up and down sampling and stays
+    // aligned with the filtered one.
+    if (auto* oversampler = getOversampler(filters))
+    {
+        auto oversampledBlock = oversampler->processSamplesUp(mainBlock);
+        auto context = juce::dsp::ProcessContextReplacing <SampleType>(oversampledBlock);
+
+        forProcessingFilter(filters, [&context](auto& f) { f.process(context); });
+        oversampler->processSamplesDown(mainBlock);
+    }
+    else
+    {
+        auto context = juce::dsp::ProcessContextReplacing <SampleType>(mainBlock);
+
+        forProcessingFilter(filters, [&context](auto& f) { f.process(context); });
+    }
+
+    // Up and down sampling and the dry/wet mix are part of this stage.
+    timer.mark(PerformanceMonitor::filter);
+
+    // Clearing what's left of the state means that the input comes back to
+    // exactly the same filters as after a reset.
+    if (inputIsSilent && getFilterStateMagnitude<SampleType>() < silenceThreshold)
+    {
+        reset();
+        idle = true;
+    }
+}
+
+template <typename SampleType>
+void SVF1AudioProcessor::updateParallelFilter(FilterSet<SampleType>& filters) noexcept
+{
+    const auto parallel = canUseParallelFilter && isNonRealtime();
+
+    if (parallel == useParallelFilter)
+        return;
+
+    // The one taking over last ran before the switch the other way, so its
+    // state is stale; it starts again from silence.
+    useParallelFilter = parallel;
+    forProcessingFilter(filters, [](auto& f) { f.reset(); });
+}
+
+template <typename SampleType>
+void SVF1AudioProcessor::padLatency(FilterSet<SampleType>& filters, const juce::dsp::AudioBlock<SampleType>& mainBlock) noexcept
+{
+    auto context = juce::dsp::ProcessContextReplacing<SampleType>(mainBlock);
+    filters.latencyPadding.setDelay(static_cast<SampleType> (latencySamples));
+    filters.latencyPadding.process(context);
+}
+
+template <typename SampleType>
+bool SVF1AudioProcessor::isInputSilent(const juce::dsp::AudioBlock<SampleType>& block) const noexcept
+{
+    const auto numInputChannels = juce::jmin((int) spec.numChannels, getMainBusNumInputChannels());
+
+    for (int channel = 0; channel < numInputChannels; ++channel)
+    {
+        const auto range = juce::FloatVectorOperations::findMinAndMax(block.getChannelPointer((size_t) channel),
+                                                                      (int) block.getNumSamples());
+
+        if (juce::jmax(-range.getStart(), range.getEnd()) >= silenceThreshold)
+            return false;
+    }
+
+    return true;
+}
+
+template <typename SampleType>
+SampleType SVF1AudioProcessor::getFilterStateMagnitude() noexcept
+{
+    auto& filters = getFilterSet<SampleType>();
+    auto magnitude = filters.splitFilter.getStateMagnitude();
+    forProcessingFilter(filters, [&magnitude](auto& f) { magnitude = juce::jmax(magnitude, f.getStateMagnitude()); });
+    return magnitude;
+}
 
-    if (!bypass->get())
+template <typename SampleType>
+void SVF1AudioProcessor::processSplitBuses(const juce::dsp::AudioBlock<SampleType>& bufferBlock)
+{
+    auto getSplitBlock = [this, &bufferBlock](int busIndex)
     {
-        auto block = juce::dsp::AudioBlock <float>(buffer);
-        auto context = juce::dsp::ProcessContextReplacing <float>(block);
-        
-        mixer.pushDrySamples(buffer);
+        auto* bus = getBus(false, busIndex);
+
+        if (bus == nullptr || ! bus->isEnabled())
+            return juce::dsp::AudioBlock<SampleType>();
+
+        return bufferBlock.getSubsetChannelBlock((size_t) bus->getChannelIndexInProcessBlockBuffer(0), spec.numChannels);
+    };
+
+    const auto lowBlock = getSplitBlock(1);
+    const auto bandBlock = getSplitBlock(2);
+    const auto highBlock = getSplitBlock(3);
+
+    if (lowBlock.getNumChannels() == 0 && bandBlock.getNumChannels() == 0 && highBlock.getNumChannels() == 0)
+        return;
+
+    auto& filters = getFilterSet<SampleType>();
+
+    // The main input starts at channel 0, and must be read before the main
+    // filter overwrites it.
+    filters.splitFilter.processMultiOutput(bufferBlock.getSubsetChannelBlock(0, spec.numChannels), lowBlock, bandBlock, highBlock);
 
-        filter.process(context);
+    // The split buses aren't oversampled, so they're delayed by the current
+    // oversampler's latency to stay aligned with the main output.
+    const juce::dsp::AudioBlock<SampleType> splitBlocks[] = { lowBlock, bandBlock, highBlock };
 
-        mixer.mixWetSamples(buffer);
+    for (size_t i = 0; i < filters.splitLatencyPadding.size(); ++i)
+    {
+        if (splitBlocks[i].getNumChannels() > 0)
+        {
+            auto context = juce::dsp::ProcessContextReplacing<SampleType>(splitBlocks[i]);
+            filters.splitLatencyPadding[i].process(context);
+        }
     }
 }
 
@@ -196,18 +589,29 @@ juce::AudioProcessorEditor* SVF1AudioProcessor::createEditor()
 //==============================================================================
 void SVF1AudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
-    copyXmlToBinary(*xml, destData);
+    // A header and one value per parameter, in its own units. Hosts ask for this
+    // for every instance on every save and undo snapshot, so it stays clear of
+    // XML and ValueTrees.
+    const auto parameters = getStateParameters();
+
+    destData.setSize(0);
+    juce::MemoryOutputStream stream(destData, false);
+    stream.preallocate(stateHeaderSize + sizeof(float) * parameters.size());
+
+    stream.writeInt(stateMagic);
+    stream.writeInt(stateVersion);
+    stream.writeInt((int) parameters.size());
+
+    for (auto* parameter : parameters)
+        stream.writeFloat(parameter->convertFrom0to1(parameter->getValue()));
 }
 
 void SVF1AudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    if (setBinaryState(data, sizeInBytes))
+        return;
+
+    // Sessions saved before the binary format hold the parameter tree as XML.
     std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
 
     if (xmlState.get() != nullptr)
@@ -215,51 +619,262 @@ void SVF1AudioProcessor::setStateInformation (const void* data, int sizeInBytes)
             apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
 }
 
+std::array<juce::RangedAudioParameter*, 10> SVF1AudioProcessor::getStateParameters() const noexcept
+{
+    return { { cutoff, resonance, type, slope, mix, oversampling, bypass, morph, morphType, drive } };
+}
+
+bool SVF1AudioProcessor::setBinaryState(const void* data, int sizeInBytes)
+{
+    if (data == nullptr || sizeInBytes < (int) stateHeaderSize)
+        return false;
+
+    juce::MemoryInputStream stream(data, (size_t) sizeInBytes, false);
+
+    if (stream.readInt() != stateMagic)
+        return false;
+
+    // Later versions only ever add parameters on the end, so whatever version
+    // wrote the state, the values this one knows about come first.
+    const auto version = stream.readInt();
+    const auto numValues = stream.readInt();
+
+    if (version < 1 || numValues < 0 || (juce::int64) numValues * (juce::int64) sizeof(float) > stream.getNumBytesRemaining())
+    {
+        jassertfalse;
+        return false;
+    }
+
+    // Parameters the state doesn't have go back to their defaults, as they do
+    // when a ValueTree is missing them.
+    const auto parameters = getStateParameters();
+
+    for (size_t i = 0; i < parameters.size(); ++i)
+    {
+        auto* parameter = parameters[i];
+
+        if ((int) i < numValues)
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(stream.readFloat()));
+        else
+            parameter->setValueNotifyingHost(parameter->getDefaultValue());
+    }
+
+    return true;
+}
+
+void SVF1AudioProcessor::markAllParametersChanged()
+{
+    for (auto* flag : { &cutoffChanged, &resonanceChanged, &typeChanged, &slopeChanged, &mixChanged, &oversamplingChanged, &bypassChanged, &morphChanged, &driveChanged })
+        flag->store(true);
+}
+
+void SVF1AudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+{
+    juce::ignoreUnused(newValue);
+
+    if (parameterID == "cutoff")
+        cutoffChanged = true;
+    else if (parameterID == "resonance")
+        resonanceChanged = true;
+    else if (parameterID == "type")
+        typeChanged = true;
+    else if (parameterID == "slope")
+        slopeChanged = true;
+    else if (parameterID == "mix")
+        mixChanged = true;
+    else if (parameterID == "oversampling")
+    {
+        oversamplingChanged = true;
+
+        // The host is told on the message thread, never from processBlock().
+        if (juce::MessageManager::existsAndIsCurrentThread())
+            updateReportedLatency();
+        else
+            triggerAsyncUpdate();
+    }
+    else if (parameterID == "bypass")
+        bypassChanged = true;
+    else if (parameterID == "morph" || parameterID == "morphType")
+        morphChanged = true;
+    else if (parameterID == "drive")
+        driveChanged = true;
+}
+
+void SVF1AudioProcessor::handleAsyncUpdate()
+{
+    updateReportedLatency();
+}
+
+void SVF1AudioProcessor::updateReportedLatency()
+{
+    // The audio thread switches factor on its next block, so the host may
+    // compensate for the old latency for a block or so.
+    setLatencySamples(oversamplingLatencies[(size_t) oversampling->getIndex()]);
+}
+
 void SVF1AudioProcessor::update()
 {
-    mixer.setWetMixProportion(mix->get());
-
-    filter.setCutoffFrequency(cutoff->get());
-    filter.setResonance(resonance->get());
-
-    switch (type->getIndex())
-    {
-    case 0:
-        filter.setType(StateVariableTPTFilterType::LP2);
-        break;
-    case 1:
-        filter.setType(StateVariableTPTFilterType::LP1);
-        break;
-    case 2:
-        filter.setType(StateVariableTPTFilterType::LP2n);
-        break;
-    case 3:
-        filter.setType(StateVariableTPTFilterType::HP2);
-        break;
-    case 4:
-        filter.setType(StateVariableTPTFilterType::HP1);
-        break;
-    case 5:
-        filter.setType(StateVariableTPTFilterType::HP2n);
-        break;
-    case 6:
-        filter.setType(StateVariableTPTFilterType::BP2);
-        break;
-    case 7:
-        filter.setType(StateVariableTPTFilterType::BP2n);
-        break;
-    case 8:
-        filter.setType(StateVariableTPTFilterType::AP2);
-        break;
-    case 9:
-        filter.setType(StateVariableTPTFilterType::P2);
-        break;
-    case 10:
-        filter.setType(StateVariableTPTFilterType::N2);
-        break;
-    default:
-        filter.setType(StateVariableTPTFilterType::LP2);
+    const auto tailChanged = cutoffChanged.load() || resonanceChanged.load() || typeChanged.load()
+                             || slopeChanged.load() || oversamplingChanged.load() || morphChanged.load()
+                             || driveChanged.load();
+
+    // First, so that the values below reach the filter after it is prepared for
+    // the new rate.
+    if (oversamplingChanged.exchange(false))
+        applyParameterValue(*oversampling, (float) oversampling->getIndex());
+
+    if (bypassChanged.exchange(false))
+        applyParameterValue(*bypass, bypass->get() ? 1.0f : 0.0f);
+
+    if (mixChanged.exchange(false))
+        applyParameterValue(*mix, mix->get());
+
+    if (cutoffChanged.exchange(false))
+        applyParameterValue(*cutoff, cutoff->get());
+
+    if (resonanceChanged.exchange(false))
+        applyParameterValue(*resonance, resonance->get());
+
+    if (slopeChanged.exchange(false))
+        applyParameterValue(*slope, (float) slope->getIndex());
+
+    if (typeChanged.exchange(false))
+        applyParameterValue(*type, (float) type->getIndex());
+
+    if (morphChanged.exchange(false))
+    {
+        applyParameterValue(*morphType, (float) morphType->getIndex());
+        applyParameterValue(*morph, morph->get());
+    }
+
+    if (driveChanged.exchange(false))
+        applyParameterValue(*drive, drive->get());
+
+    if (tailChanged)
+        updateTailLength();
+}
+
+void SVF1AudioProcessor::applyParameterValue(const juce::RangedAudioParameter& parameter, float value)
+{
+    if (&parameter == oversampling)
+    {
+        const auto newOversamplingIndex = (size_t) value;
+
+        if (newOversamplingIndex != oversamplingIndex)
+        {
+            oversamplingIndex = newOversamplingIndex;
+            prepareFilters();
+
+            forActiveFilterSet([this](auto& filters)
+            {
+                if (auto* oversampler = getOversampler(filters))
+                    oversampler->reset();
+            });
+        }
+    }
+    else if (&parameter == bypass)
+    {
+        bypassed = value >= 0.5f;
+    }
+    else if (&parameter == mix)
+    {
+        forActiveFilter([value](auto& f) { f.setWetMixProportion(value); });
+    }
+    else if (&parameter == cutoff)
+    {
+        forActiveFilterSet([this, value](auto& filters)
+        {
+            forActiveFilter(filters, [value](auto& f) { f.setCutoffFrequency(value); });
+            filters.splitFilter.setCutoffFrequency(value);
+        });
+    }
+    else if (&parameter == resonance)
+    {
+        forActiveFilterSet([this, value](auto& filters)
+        {
+            forActiveFilter(filters, [value](auto& f) { f.setResonance(value); });
+            filters.splitFilter.setResonance(value);
+        });
+    }
+    else if (&parameter == slope)
+    {
+        // Each choice adds a 12 dB / octave stage to the LP2 and HP2 types.
+        const auto newNumStages = (size_t) value + 1;
+        forActiveFilter([newNumStages](auto& f) { f.setNumStages(newNumStages); });
+    }
+    else if (&parameter == type)
+    {
+        // Type changes and morphing are both crossfaded inside the filter
+        // kernel, so automating either costs next to nothing.
+        const auto newType = getFilterType((int) value);
+        forActiveFilter([newType](auto& f) { f.setType(newType); });
+    }
+    else if (&parameter == morphType)
+    {
+        const auto newMorphType = getFilterType((int) value);
+        forActiveFilter([newMorphType](auto& f) { f.setMorphType(newMorphType); });
+    }
+    else if (&parameter == morph)
+    {
+        forActiveFilter([value](auto& f) { f.setMorphProportion(value); });
+    }
+    else if (&parameter == drive)
+    {
+        // Only the main filter saturates: the split buses stay linear, so that
+        // Low, Band and High still sum back to the input.
+        forActiveFilter([value](auto& f) { f.setDrive(value); });
+    }
+}
+
+StateVariableTPTFilterType SVF1AudioProcessor::getFilterType(int typeIndex) noexcept
+{
+    switch (typeIndex)
+    {
+    case 0:     return StateVariableTPTFilterType::LP2;
+    case 1:     return StateVariableTPTFilterType::LP1;
+    case 2:     return StateVariableTPTFilterType::LP2n;
+    case 3:     return StateVariableTPTFilterType::HP2;
+    case 4:     return StateVariableTPTFilterType::HP1;
+    case 5:     return StateVariableTPTFilterType::HP2n;
+    case 6:     return StateVariableTPTFilterType::BP2;
+    case 7:     return StateVariableTPTFilterType::BP2n;
+    case 8:     return StateVariableTPTFilterType::AP2;
+    case 9:     return StateVariableTPTFilterType::P2;
+    case 10:    return StateVariableTPTFilterType::N2;
+    default:    return StateVariableTPTFilterType::LP2;
+    }
+}
+
+StateVariableTPTFilterResponse SVF1AudioProcessor::getFilterResponse()
+{
+    // The filters run at the oversampled rate, and so does their response.
+    const auto baseRate = getSampleRate() > 0.0 ? getSampleRate() : 44100.0;
+    const auto rate = baseRate * (double) (1 << oversampling->getIndex());
+
+    if (rate != responseFilterSampleRate)
+    {
+        responseFilterSampleRate = rate;
+        responseFilter.prepare({ rate, 1, 1 });
     }
+
+    responseFilter.setType(getFilterType(type->getIndex()));
+    responseFilter.setMorphType(getFilterType(morphType->getIndex()));
+    responseFilter.setMorphProportion(morph->get());
+    responseFilter.setCutoffFrequency(juce::jmin((double) cutoff->get(), 0.49 * rate));
+    responseFilter.setResonance(resonance->get());
+    responseFilter.setNumStages((size_t) slope->getIndex() + 1);
+    responseFilter.setWetMixProportion(mix->get());
+
+    return responseFilter.getResponse();
+}
+
+void SVF1AudioProcessor::updateTailLength()
+{
+    // Long for low cutoffs and high resonances: a Q of 100 at 20 Hz takes over
+    // 20 seconds to decay by 120 dB. Oversampling doesn't change it in seconds.
+    auto seconds = 0.0;
+    forActiveFilter([&seconds](auto& f) { seconds = f.getTailLengthSeconds(); });
+    tailLengthSeconds = seconds;
 }
 
 //==============================================================================
@@ -281,6 +896,24 @@ juce::AudioProcessorValueTreeState::ParameterLayout SVF1AudioProcessor::createPa
 
     layout.add(std::make_unique<AudioParameterBool>("bypass", "Bypass", false));
 
+    // New parameters only ever go after the others, so that hosts that address
+    // parameters by index still find the older ones where they were.
+    layout.add(std::make_unique<AudioParameterChoice>("slope", "Slope", juce::StringArray{ "12 dB/oct", "24 dB/oct", "36 dB/oct", "48 dB/oct" }, 0));
+
+    layout.add(std::make_unique<AudioParameterChoice>("oversampling", "Oversampling", juce::StringArray{ "1x", "2x", "4x", "8x" }, 0));
+
+    layout.add(std::make_unique<AudioParameterFloat>("morph", "Morph", NormalisableRange<float>(0.00f, 1.00f, 00.01f), 0.00f));
+
+    layout.add(std::make_unique<AudioParameterChoice>("morphType", "Morph To", juce::StringArray{ "LP2", "LP1", "LP2n", "HP2", "HP1", "HP2n", "BP2", "BP2n", "AP2", "P2", "N2"}, 3));
+
+    // The gain into the saturator inside the loop, shown in dB. At 0 the filter
+    // is linear and costs what it did before.
+    auto driveRange = NormalisableRange<float>(0.00f, 8.00f, 00.01f, 0.5f);
+    auto driveToText = [](float value, int) { return value > 0.0f ? String(Decibels::gainToDecibels(value), 1) + " dB" : String("Off"); };
+    auto textToDrive = [](const String& text) { return text.trim().equalsIgnoreCase("Off") ? 0.0f : Decibels::decibelsToGain(text.getFloatValue()); };
+    layout.add(std::make_unique<AudioParameterFloat>("drive", "Drive", driveRange, 0.00f, String(), AudioProcessorParameter::genericParameter,
+                                                     driveToText, textToDrive));
+
     return layout;
 }
 
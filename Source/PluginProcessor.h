@@ -10,11 +10,17 @@
 
 //#include <JuceHeader.h>
 #include "SVF.h"
+#include "SVFParallel.h"
+#include "PerformanceMonitor.h"
+#include "RealtimeSafety.h"
+#include "SpectrumAnalyser.h"
 
 //==============================================================================
 /**
 */
-class SVF1AudioProcessor  : public juce::AudioProcessor
+class SVF1AudioProcessor  : public juce::AudioProcessor,
+                            private juce::AudioProcessorValueTreeState::Listener,
+                            private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -33,6 +39,12 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    /** The filters, mix and oversampling all run natively in double precision
+        when the host asks for it, so 64-bit hosts don't convert every buffer.
+    */
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -57,6 +69,13 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    //==============================================================================
+    /** The widest main bus supported, which takes up to 15th order ambisonics. */
+    static constexpr int maxNumChannels = 256;
+
+    /** Offline, buses at least this wide are split over worker threads. */
+    static constexpr juce::uint32 minNumParallelChannels = 32;
+
     //==============================================================================
     using APVTS = juce::AudioProcessorValueTreeState;
     static APVTS::ParameterLayout createParameterLayout();
@@ -69,22 +88,319 @@ public:
     /** Resets the internal state variables of the processor. */
     void reset();
 
+    /** Queues a change to a parameter, in its own units, for sampleOffset samples
+        into the next processBlock(). The block is split at each change so that
+        it starts on exactly that sample, and then glides over the same ramp
+        time as any other change; a block with nothing queued runs in one piece
+        as usual.
+
+        This is for offline rendering, such as SVF1Render, which knows the
+        sample of every change. A host's automation still arrives between
+        blocks and applies to whole blocks, as JUCE passes it on. The change
+        goes straight to the DSP: the parameter keeps its value, and the host
+        isn't told, so nothing host-facing happens inside processBlock(). It
+        lasts until the parameter next changes, or the next prepareToPlay().
+        Call it from the thread that calls processBlock().
+    */
+    void scheduleParameterChange(int sampleOffset, juce::RangedAudioParameter& parameter, float value) noexcept;
+
+    /** Timings of processBlock, for the editor. Set the SVF1_PERFORMANCE_LOG
+        environment variable to also have them logged once a second, inside a
+        host or the standalone app; the console tools have no message loop to
+        run the logging on.
+    */
+    PerformanceMonitor& getPerformanceMonitor() noexcept { return performanceMonitor; }
+
+    /** Returns the response of the filter for the current parameter values, at
+        the rate it runs at, for drawing or querying without running any signal.
+        It's worked out from the parameters rather than read from the filters
+        the audio thread is using. Message thread only.
+    */
+    StateVariableTPTFilterResponse getFilterResponse();
+
+    /** The input and output spectra, for the editor. */
+    SpectrumAnalyser& getSpectrumAnalyser() noexcept { return spectrumAnalyser; }
+
 private:
     //==============================================================================
-    /** Updates the internal state variables of the processor. */
+    /** The DSP for one sample type. There is one set for float and one for
+        double, and only the set for the host's processing precision is
+        prepared and run.
+    */
+    template <typename SampleType>
+    struct FilterSet
+    {
+        StateVariableTPTFilter<SampleType, 1> monoFilter;
+        StateVariableTPTFilter<SampleType, 2> stereoFilter;
+        StateVariableTPTFilter<SampleType> filter;
+        ParallelStateVariableTPTFilter<SampleType> parallelFilter;
+
+        /** Feeds the optional Low/Band/High buses, all three in a single pass. */
+        StateVariableTPTFilter<SampleType> splitFilter;
+
+        /** Polyphase IIR half-band oversamplers for 2x, 4x and 8x, all created in
+            prepareToPlay() so that switching between them never allocates.
+        */
+        std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, 3> oversamplers;
+
+        /** Delay the main output while bypassed, and the Low/Band/High buses,
+            which aren't oversampled, by the current oversampler's latency.
+        */
+        juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::None> latencyPadding;
+        std::array<juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::None>, 3> splitLatencyPadding;
+    };
+
+    /** Returns the set for a sample type. */
+    template <typename SampleType>
+    FilterSet<SampleType>& getFilterSet() noexcept;
+
+    //==============================================================================
+    /** Updates the internal state variables of the processor. Only parameters
+        that have changed since the last call are passed on to the DSP.
+    */
     void update();
 
+    /** Passes a parameter's value, in its own units, on to the DSP. update()
+        calls it with the parameters' values, and scheduled changes with their
+        own, which never go through the parameters.
+    */
+    void applyParameterValue(const juce::RangedAudioParameter& parameter, float value);
+
+    /** Returns the filter type for an index of the type parameter. */
+    static StateVariableTPTFilterType getFilterType(int typeIndex) noexcept;
+
+    /** Works out the tail length from the current cutoff, resonance, stages and drive. */
+    void updateTailLength();
+
+    /** The body of both processBlock() overloads. */
+    template <typename SampleType>
+    void processBuffer(juce::AudioBuffer<SampleType>& buffer) noexcept;
+
+    /** True if the main input channels are all below silenceThreshold. */
+    template <typename SampleType>
+    bool isInputSilent(const juce::dsp::AudioBlock<SampleType>& block) const noexcept;
+
+    /** Runs the filters over a block, or a part of one, with the parameters as
+        they are.
+    */
+    template <typename SampleType>
+    void processSubBlock(const juce::dsp::AudioBlock<SampleType>& block, PerformanceMonitor::BlockTimer& timer) noexcept;
+
+    /** Runs a block in sub-blocks from one scheduled change to the next. */
+    template <typename SampleType>
+    void processScheduledChanges(const juce::dsp::AudioBlock<SampleType>& block, PerformanceMonitor::BlockTimer& timer) noexcept;
+
+    /** Returns the largest state variable of the filters that are running. */
+    template <typename SampleType>
+    SampleType getFilterStateMagnitude() noexcept;
+
+    /** The parameters in the order the binary state stores them. New parameters
+        only ever go on the end, and none are ever removed.
+    */
+    std::array<juce::RangedAudioParameter*, 10> getStateParameters() const noexcept;
+
+    /** Restores the parameters from getStateInformation()'s binary format.
+        Returns false if the data isn't in that format.
+    */
+    bool setBinaryState(const void* data, int sizeInBytes);
+
+    /** Marks every parameter as changed, so the next update() applies them all. */
+    void markAllParametersChanged();
+
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+
+    /** Reports the latency of the oversampling factor the parameter is set to.
+        Message thread only.
+    */
+    void updateReportedLatency();
+
+    /** Calls a function on the FilterSet for the host's processing precision. */
+    template <typename Function>
+    void forActiveFilterSet(Function&& function)
+    {
+        if (isUsingDoublePrecision())
+            function(doubleFilters);
+        else
+            function(floatFilters);
+    }
+
+    /** Calls a function on the filter variants that match the prepared channel
+        count: the fixed mono and stereo filters keep their state inline, and
+        any other layout uses the dynamic one, along with the parallel one for
+        wide buses. Both of those are kept prepared and set up alike, so that
+        either can take over from one block to the next.
+    */
+    template <typename SampleType, typename Function>
+    void forActiveFilter(FilterSet<SampleType>& filters, Function&& function)
+    {
+        switch (spec.numChannels)
+        {
+        case 1:     function(filters.monoFilter); break;
+        case 2:     function(filters.stereoFilter); break;
+        default:
+            function(filters.filter);
+
+            if (canUseParallelFilter)
+                function(filters.parallelFilter);
+
+            break;
+        }
+    }
+
+    /** As above, but only the variant that processes the current block: the
+        parallel one while the host renders offline, and the dynamic one
+        otherwise.
+    */
+    template <typename SampleType, typename Function>
+    void forProcessingFilter(FilterSet<SampleType>& filters, Function&& function)
+    {
+        switch (spec.numChannels)
+        {
+        case 1:     function(filters.monoFilter); break;
+        case 2:     function(filters.stereoFilter); break;
+        default:
+            if (useParallelFilter)
+                function(filters.parallelFilter);
+            else
+                function(filters.filter);
+
+            break;
+        }
+    }
+
+    /** Switches between the dynamic and parallel filters if the host has gone
+        into or out of offline rendering since the last block. Hosts needn't
+        prepare again when they do, so this is checked on every block.
+    */
+    template <typename SampleType>
+    void updateParallelFilter(FilterSet<SampleType>& filters) noexcept;
+
+    /** As above, in the set for the host's processing precision. */
+    template <typename Function>
+    void forActiveFilter(Function&& function)
+    {
+        forActiveFilterSet([this, &function](auto& filters) { forActiveFilter(filters, function); });
+    }
+
+    /** Runs the split filter from the main input into whichever of the Low, Band
+        and High output buses are enabled.
+    */
+    template <typename SampleType>
+    void processSplitBuses(const juce::dsp::AudioBlock<SampleType>& bufferBlock);
+
+    /** Creates a set's oversamplers and prepares its filters. */
+    template <typename SampleType>
+    void prepareFilterSet(FilterSet<SampleType>& filters);
+
+    /** Prepares the active filter for the current oversampling factor, and sets
+        the latency padding to match. Nothing is allocated and nothing reaches
+        the host once prepare() has run, so this can be called on the audio
+        thread.
+    */
+    void prepareFilters();
+
+    /** Delays the main output by the current factor's latency, for bypass. */
+    template <typename SampleType>
+    void padLatency(FilterSet<SampleType>& filters, const juce::dsp::AudioBlock<SampleType>& mainBlock) noexcept;
+
+    /** Returns a set's oversampler for the current factor, or nullptr at 1x. */
+    template <typename SampleType>
+    juce::dsp::Oversampling<SampleType>* getOversampler(const FilterSet<SampleType>& filters) const noexcept
+    {
+        return oversamplingIndex > 0 ? filters.oversamplers[oversamplingIndex - 1].get() : nullptr;
+    }
+
+    /** Calls a function on every filter, in both sets, the split filters too. */
+    template <typename Function>
+    void forEachFilter(Function&& function)
+    {
+        forEachFilter(floatFilters, function);
+        forEachFilter(doubleFilters, function);
+    }
+
+    template <typename SampleType, typename Function>
+    void forEachFilter(FilterSet<SampleType>& filters, Function&& function)
+    {
+        function(filters.monoFilter);
+        function(filters.stereoFilter);
+        function(filters.filter);
+        function(filters.parallelFilter);
+        function(filters.splitFilter);
+    }
+
     //==============================================================================
     juce::dsp::ProcessSpec spec;
     //juce::dsp::StateVariableTPTFilter<float> filter;
-    juce::dsp::DryWetMixer<float> mixer;
-    StateVariableTPTFilter<float> filter;
+    FilterSet<float> floatFilters;
+    FilterSet<double> doubleFilters;
+
+    /** Set in prepareToPlay() for buses wide enough to split over threads. */
+    bool canUseParallelFilter = false;
+
+    /** True while the parallel filter processes the blocks, which it only does
+        offline, as it waits for its workers. Audio thread only.
+    */
+    bool useParallelFilter = false;
+
+    /** Mirrors the parameters on the message thread, for getFilterResponse(). */
+    StateVariableTPTFilter<double, 1> responseFilter;
+    double responseFilterSampleRate = 0.0;
+
+    size_t oversamplingIndex = 0;
+
+    /** The latency of each oversampling factor, from 1x up, worked out in
+        prepare(), and that of the current one. Each factor reports its own, so
+        1x adds none.
+    */
+    std::array<int, 4> oversamplingLatencies {};
+    int latencySamples = 0;
 
     juce::AudioParameterFloat* cutoff { nullptr };
     juce::AudioParameterFloat* resonance { nullptr };
     juce::AudioParameterChoice* type { nullptr };
+    juce::AudioParameterChoice* slope { nullptr };
     juce::AudioParameterFloat* mix { nullptr };
+    juce::AudioParameterChoice* oversampling { nullptr };
     juce::AudioParameterBool* bypass { nullptr };
+    juce::AudioParameterFloat* morph { nullptr };
+    juce::AudioParameterChoice* morphType { nullptr };
+    juce::AudioParameterFloat* drive { nullptr };
+
+    PerformanceMonitor performanceMonitor;
+    SpectrumAnalyser spectrumAnalyser;
+
+    /** Input below this is silence, and filters whose state is below it have rung
+        out (-120 dB).
+    */
+    static constexpr float silenceThreshold = 1.0e-6f;
+
+    /** The binary state starts with "SVF1", the version and the number of values. */
+    static constexpr int stateMagic = 0x31465653, stateVersion = 1;
+    static constexpr size_t stateHeaderSize = 3 * sizeof(int);
+
+    /** True while the input is silent and the filters have rung out, so that
+        processBlock() has nothing to compute. Audio thread only.
+    */
+    bool idle = false;
+
+    /** The bypass parameter, or a scheduled change to it. Audio thread only. */
+    bool bypassed = false;
+
+    std::atomic<double> tailLengthSeconds { 0.0 };
+
+    struct ScheduledChange
+    {
+        int sampleOffset;
+        juce::RangedAudioParameter* parameter;
+        float value;
+    };
+
+    /** Changes for the next block, in order of offset. Audio thread only. */
+    std::array<ScheduledChange, 512> scheduledChanges;
+    size_t numScheduledChanges = 0;
+
+    std::atomic<bool> cutoffChanged { true }, resonanceChanged { true }, typeChanged { true }, slopeChanged { true }, mixChanged { true }, oversamplingChanged { true }, bypassChanged { true }, morphChanged { true }, driveChanged { true };
     //juce::UndoManager undoManager;
 
     //==============================================================================
@@ -0,0 +1,344 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.cpp
+    Created: 17 Oct 2026 9:12:40pm
+    Author:  StoneyDSP
+
+  ==============================================================================
+*/
+
+#include "RealtimeSafety.h"
+
+#if SVF1_REALTIME_SAFETY_CHECKS
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if JUCE_LINUX
+ #include <cerrno>
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #include <semaphore.h>
+ #include <unistd.h>
+#elif JUCE_WINDOWS && JUCE_DEBUG
+ #include <crtdbg.h>
+#endif
+
+//==============================================================================
+namespace
+{
+    // Plain thread locals, so that reading them never allocates, even from
+    // inside malloc.
+    thread_local int realtimeDepth = 0;
+    thread_local int suspensionDepth = 0;
+
+    std::atomic<int> numViolations { 0 };
+
+    void writeToStandardError(const char* call)
+    {
+        const auto trace = juce::SystemStats::getStackBacktrace();
+        std::fprintf(stderr, "Real-time safety violation: %s\n%s\n", call, trace.toRawUTF8());
+    }
+
+    std::atomic<RealtimeSafety::ViolationHandler> violationHandler { writeToStandardError };
+
+    void* allocate(std::size_t size, const char* call) noexcept
+    {
+        RealtimeSafety::check(call);
+
+        // malloc would report the same allocation again.
+        const RealtimeSafety::ScopedSuspension suspension;
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void deallocate(void* pointer, const char* call) noexcept
+    {
+        if (pointer == nullptr)
+            return;
+
+        RealtimeSafety::check(call);
+
+        const RealtimeSafety::ScopedSuspension suspension;
+        std::free(pointer);
+    }
+
+   #if __cpp_aligned_new
+    void* allocateAligned(std::size_t size, std::size_t alignment, const char* call) noexcept
+    {
+        RealtimeSafety::check(call);
+
+        const RealtimeSafety::ScopedSuspension suspension;
+
+       #if JUCE_WINDOWS
+        return _aligned_malloc(size == 0 ? 1 : size, alignment);
+       #else
+        void* pointer = nullptr;
+        return posix_memalign(&pointer, juce::jmax(alignment, sizeof(void*)), size == 0 ? 1 : size) == 0 ? pointer : nullptr;
+       #endif
+    }
+
+    void deallocateAligned(void* pointer, const char* call) noexcept
+    {
+        if (pointer == nullptr)
+            return;
+
+        RealtimeSafety::check(call);
+
+        const RealtimeSafety::ScopedSuspension suspension;
+
+       #if JUCE_WINDOWS
+        _aligned_free(pointer);
+       #else
+        std::free(pointer);
+       #endif
+    }
+   #endif
+}
+
+//==============================================================================
+namespace RealtimeSafety
+{
+    void setViolationHandler(ViolationHandler handler) noexcept
+    {
+        violationHandler = handler != nullptr ? handler : writeToStandardError;
+    }
+
+    int getNumViolations() noexcept      { return numViolations.load(); }
+    void resetNumViolations() noexcept   { numViolations = 0; }
+
+    void check(const char* call) noexcept
+    {
+        if (realtimeDepth == 0 || suspensionDepth > 0)
+            return;
+
+        // The handler allocates, for the stack trace at least.
+        const ScopedSuspension suspension;
+
+        ++numViolations;
+        violationHandler.load()(call);
+    }
+
+    ScopedRealtimeSection::ScopedRealtimeSection(bool isRealtime) noexcept
+        : active(isRealtime)
+    {
+        if (active)
+            ++realtimeDepth;
+    }
+
+    ScopedRealtimeSection::~ScopedRealtimeSection()
+    {
+        if (active)
+            --realtimeDepth;
+    }
+
+    ScopedSuspension::ScopedSuspension() noexcept    { ++suspensionDepth; }
+    ScopedSuspension::~ScopedSuspension()            { --suspensionDepth; }
+}
+
+//==============================================================================
+void* operator new(std::size_t size)
+{
+    if (auto* pointer = allocate(size, "operator new"))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    if (auto* pointer = allocate(size, "operator new[]"))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept     { return allocate(size, "operator new"); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept   { return allocate(size, "operator new[]"); }
+
+void operator delete(void* pointer) noexcept                                { deallocate(pointer, "operator delete"); }
+void operator delete[](void* pointer) noexcept                              { deallocate(pointer, "operator delete[]"); }
+void operator delete(void* pointer, std::size_t) noexcept                   { deallocate(pointer, "operator delete"); }
+void operator delete[](void* pointer, std::size_t) noexcept                 { deallocate(pointer, "operator delete[]"); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept         { deallocate(pointer, "operator delete"); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept       { deallocate(pointer, "operator delete[]"); }
+
+// The over-aligned forms, which SIMD types and cache line aligned state go
+// through when the language standard has them.
+#if __cpp_aligned_new
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (auto* pointer = allocateAligned(size, static_cast<std::size_t> (alignment), "operator new"))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if (auto* pointer = allocateAligned(size, static_cast<std::size_t> (alignment), "operator new[]"))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocateAligned(size, static_cast<std::size_t> (alignment), "operator new");
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocateAligned(size, static_cast<std::size_t> (alignment), "operator new[]");
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept                                  { deallocateAligned(pointer, "operator delete"); }
+void operator delete[](void* pointer, std::align_val_t) noexcept                                { deallocateAligned(pointer, "operator delete[]"); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept                     { deallocateAligned(pointer, "operator delete"); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept                   { deallocateAligned(pointer, "operator delete[]"); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept           { deallocateAligned(pointer, "operator delete"); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept         { deallocateAligned(pointer, "operator delete[]"); }
+#endif
+
+//==============================================================================
+#if JUCE_LINUX
+
+// glibc's allocator is still there under these names, so the interceptors can
+// hand over to it without having to look it up first.
+extern "C" void* __libc_malloc(std::size_t);
+extern "C" void* __libc_calloc(std::size_t, std::size_t);
+extern "C" void* __libc_realloc(void*, std::size_t);
+extern "C" void __libc_free(void*);
+extern "C" void* __libc_memalign(std::size_t, std::size_t);
+
+extern "C" void* malloc(std::size_t size) noexcept
+{
+    RealtimeSafety::check("malloc");
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(std::size_t numElements, std::size_t size) noexcept
+{
+    RealtimeSafety::check("calloc");
+    return __libc_calloc(numElements, size);
+}
+
+extern "C" void* realloc(void* pointer, std::size_t size) noexcept
+{
+    RealtimeSafety::check("realloc");
+    return __libc_realloc(pointer, size);
+}
+
+extern "C" void free(void* pointer) noexcept
+{
+    if (pointer != nullptr)
+        RealtimeSafety::check("free");
+
+    __libc_free(pointer);
+}
+
+extern "C" int posix_memalign(void** pointer, std::size_t alignment, std::size_t size) noexcept
+{
+    RealtimeSafety::check("posix_memalign");
+
+    // The same checks that glibc's own makes, as memalign doesn't.
+    if (alignment % sizeof(void*) != 0 || ! juce::isPowerOfTwo(alignment))
+        return EINVAL;
+
+    auto* allocated = __libc_memalign(alignment, size);
+
+    if (allocated == nullptr && size != 0)
+        return ENOMEM;
+
+    *pointer = allocated;
+    return 0;
+}
+
+extern "C" void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept
+{
+    RealtimeSafety::check("aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+extern "C" void* memalign(std::size_t alignment, std::size_t size) noexcept
+{
+    RealtimeSafety::check("memalign");
+    return __libc_memalign(alignment, size);
+}
+
+//==============================================================================
+namespace
+{
+    /** The definition that this file's interceptor hides, looked up on first use. */
+    template <typename Function>
+    Function* findNext(std::atomic<Function*>& cache, const char* name) noexcept
+    {
+        auto* function = cache.load(std::memory_order_relaxed);
+
+        if (function == nullptr)
+        {
+            function = reinterpret_cast<Function*> (dlsym(RTLD_NEXT, name));
+            cache.store(function, std::memory_order_relaxed);
+        }
+
+        return function;
+    }
+}
+
+#define SVF1_INTERCEPT(returnType, name, parameters, arguments, exceptionSpec) \
+    extern "C" returnType name parameters exceptionSpec \
+    { \
+        using Function = returnType parameters; \
+        static std::atomic<Function*> next { nullptr }; \
+        RealtimeSafety::check(#name); \
+        return findNext(next, #name) arguments; \
+    }
+
+SVF1_INTERCEPT(int, pthread_mutex_lock, (pthread_mutex_t* mutex), (mutex), noexcept)
+SVF1_INTERCEPT(int, pthread_rwlock_rdlock, (pthread_rwlock_t* lock), (lock), noexcept)
+SVF1_INTERCEPT(int, pthread_rwlock_wrlock, (pthread_rwlock_t* lock), (lock), noexcept)
+SVF1_INTERCEPT(int, pthread_cond_wait, (pthread_cond_t* condition, pthread_mutex_t* mutex), (condition, mutex), )
+SVF1_INTERCEPT(int, pthread_cond_timedwait, (pthread_cond_t* condition, pthread_mutex_t* mutex, const timespec* time),
+               (condition, mutex, time), )
+SVF1_INTERCEPT(int, sem_wait, (sem_t* semaphore), (semaphore), )
+SVF1_INTERCEPT(int, nanosleep, (const timespec* duration, timespec* remaining), (duration, remaining), )
+SVF1_INTERCEPT(int, usleep, (useconds_t microseconds), (microseconds), )
+
+#undef SVF1_INTERCEPT
+
+//==============================================================================
+#elif JUCE_WINDOWS && JUCE_DEBUG
+
+namespace
+{
+    int allocationHook(int allocationType, void*, std::size_t, int blockType, long, const unsigned char*, int)
+    {
+        // _CRT_BLOCKs are the runtime's own bookkeeping.
+        if (blockType != _CRT_BLOCK)
+            RealtimeSafety::check(allocationType == _HOOK_FREE ? "free"
+                                  : allocationType == _HOOK_REALLOC ? "realloc" : "malloc");
+
+        return TRUE;
+    }
+
+    struct AllocationHookInstaller
+    {
+        AllocationHookInstaller()   { _CrtSetAllocHook(allocationHook); }
+    };
+
+    const AllocationHookInstaller allocationHookInstaller;
+}
+
+#endif
+
+#else
+
+namespace RealtimeSafety
+{
+    void setViolationHandler(ViolationHandler) noexcept {}
+    int getNumViolations() noexcept      { return 0; }
+    void resetNumViolations() noexcept   {}
+}
+
+#endif
@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.h
+    Created: 17 Oct 2026 9:12:40pm
+    Author:  StoneyDSP
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/** Define this as 1 to have everything that can allocate or block on the audio
+    thread reported. It costs a check on every allocation and lock in the
+    process, so it is for test builds such as SVF1Audit, never for release.
+*/
+#ifndef SVF1_REALTIME_SAFETY_CHECKS
+ #define SVF1_REALTIME_SAFETY_CHECKS 0
+#endif
+
+//==============================================================================
+/** Checks that the audio thread neither allocates nor blocks.
+
+    Code that must be real-time safe marks itself with a ScopedRealtimeSection.
+    With SVF1_REALTIME_SAFETY_CHECKS on, the calls below are intercepted while a
+    thread is inside one, and each is reported with a stack trace:
+
+    - operator new and delete, everywhere, the aligned forms too where the
+      language standard has them;
+    - malloc, calloc, realloc and free, and posix_memalign, aligned_alloc and
+      memalign, on Linux, and through the CRT's allocation hook in Windows
+      debug builds;
+    - mutex locks, condition variable and semaphore waits, and sleeps, on Linux.
+
+    Linux therefore gives the complete picture, and the other platforms catch
+    the allocations, which are the most common problem. With the checks off, a
+    ScopedRealtimeSection is empty and costs nothing.
+*/
+namespace RealtimeSafety
+{
+    /** Called for every violation, with what was called. The default handler
+        writes the call and a stack trace to stderr.
+    */
+    using ViolationHandler = void (*) (const char* call);
+
+    /** Replaces the handler; nullptr restores the default one. Set it before
+        any audio runs.
+    */
+    void setViolationHandler(ViolationHandler handler) noexcept;
+
+    /** The number of violations since the last reset. */
+    int getNumViolations() noexcept;
+    void resetNumViolations() noexcept;
+
+    /** True if the checks are compiled in. */
+    constexpr bool areChecksEnabled() noexcept { return SVF1_REALTIME_SAFETY_CHECKS != 0; }
+
+   #if SVF1_REALTIME_SAFETY_CHECKS
+    /** Reports a call, if the calling thread is inside a ScopedRealtimeSection
+        and the checks aren't suspended. The interceptors call this; call it
+        yourself to cover anything else that might block.
+    */
+    void check(const char* call) noexcept;
+
+    //==============================================================================
+    /** Marks the calling thread as real-time for as long as it exists.
+        Sections nest.
+    */
+    class ScopedRealtimeSection
+    {
+    public:
+        explicit ScopedRealtimeSection(bool isRealtime = true) noexcept;
+        ~ScopedRealtimeSection();
+
+    private:
+        const bool active;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedRealtimeSection)
+    };
+
+    /** Lets the calling thread allocate and block for as long as it exists, for
+        code that knowingly breaks the rules.
+    */
+    class ScopedSuspension
+    {
+    public:
+        ScopedSuspension() noexcept;
+        ~ScopedSuspension();
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedSuspension)
+    };
+   #else
+    inline void check(const char*) noexcept {}
+
+    class ScopedRealtimeSection
+    {
+    public:
+        explicit ScopedRealtimeSection(bool = true) noexcept {}
+    };
+
+    class ScopedSuspension
+    {
+    public:
+        ScopedSuspension() noexcept {}
+    };
+   #endif
+}
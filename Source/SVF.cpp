@@ -11,89 +11,1462 @@
 #include "SVF.h"
 
 //==============================================================================
-template <typename SampleType>
-StateVariableTPTFilter<SampleType>::StateVariableTPTFilter()
+namespace
 {
+    /** A cache line on every platform we build for, and a multiple of the SIMD
+        register alignment.
+    */
+    constexpr size_t cacheLineSize = 64;
+
+    /** Returns the first cache line aligned element at or after the given raw storage. */
+    template <typename SampleType>
+    SampleType* getCacheLineAlignedPtr(char* data) noexcept
+    {
+        const auto address = reinterpret_cast<juce::pointer_sized_uint> (data);
+        return reinterpret_cast<SampleType*> ((address + cacheLineSize - 1) & ~(juce::pointer_sized_uint) (cacheLineSize - 1));
+    }
+}
+
+//==============================================================================
+namespace
+{
+    /** max(0, x) without a comparison, which is exact, and which compilers can't
+        split into branches on x <= 0 the way they do with a select.
+    */
+    template <typename T>
+    forcedinline T getPositivePart(T x) noexcept
+    {
+        return (x + std::abs(x)) * static_cast<T> (0.5);
+    }
+
+    /** The saturator is u + getSaturationResidual(u): linear up to 0.5, a
+        parabolic knee up to 1.5 and flat at 1 from there. With p and e the
+        amounts by which |u| passes 0.5 and 1.5, its slope is 1 - knee, where
+        knee = p - e, and the residual's size is (p^2 - e^2) / 2. Written that
+        way, without clamping knee and with the sign copied rather than
+        selected, it's all arithmetic that vectorises. Only the residual is
+        antialiased, so that signals that never reach the knee come out
+        exactly as the linear filter's.
+    */
+    template <typename T>
+    forcedinline T getSaturationResidual(T u, T& knee) noexcept
+    {
+        const auto a = std::abs(u);
+        const auto p = getPositivePart(a - static_cast<T> (0.5));
+        const auto e = getPositivePart(a - static_cast<T> (1.5));
+        knee = p - e;
+
+        const auto r = knee * (p + e) * static_cast<T> (0.5);
+        return -std::copysign(r, u);
+    }
+
+    /** The antiderivative of getSaturationResidual(), 0 at 0, which is
+        -(p^3 - e^3) / 6.
+    */
+    template <typename T>
+    forcedinline T getSaturationResidualIntegral(T u) noexcept
+    {
+        const auto a = std::abs(u);
+        const auto p = getPositivePart(a - static_cast<T> (0.5));
+        const auto e = getPositivePart(a - static_cast<T> (1.5));
+
+        return (p - e) * (p * p + p * e + e * e) * static_cast<T> (-1.0 / 6.0);
+    }
+
+    /** Below this step in the saturator's input, the difference of
+        antiderivatives loses more to rounding than the midpoint loses to
+        curvature, about the cube root of the epsilon.
+    */
+    template <typename T>
+    constexpr T getAntiderivativeTolerance() noexcept
+    {
+        return static_cast<T> (sizeof(T) == sizeof(float) ? 5.0e-3 : 6.0e-6);
+    }
+
+    /** The residual averaged over the step from the last input to u, the
+        difference of antiderivatives over the difference, or the residual at the
+        midpoint once the step is too small for that to be accurate. slope is its
+        derivative by u, which is never below -1 as the saturator is monotonic.
+    */
+    template <typename T>
+    forcedinline T getAveragedSaturationResidual(T u, T last, T lastIntegral, T& slope) noexcept
+    {
+        // A blend between the two by 0 or 1 rather than a condition, with a step
+        // that can always be divided by, so that compilers vectorise it instead
+        // of branching around the division.
+        const auto du = u - last;
+        const auto isSmallStep = static_cast<T> (std::abs(du) <= getAntiderivativeTolerance<T>());
+        const auto inverseStep = static_cast<T> (1) / (du + isSmallStep);
+
+        T knee, midKnee;
+        const auto residual = getSaturationResidual(u, knee);
+        const auto midResidual = getSaturationResidual((u + last) * static_cast<T> (0.5), midKnee);
+        const auto average = (getSaturationResidualIntegral(u) - lastIntegral) * inverseStep;
+        const auto averageSlope = (residual - average) * inverseStep;
+
+        slope = averageSlope + (midKnee * static_cast<T> (-0.5) - averageSlope) * isSmallStep;
+        return average + (midResidual - average) * isSmallStep;
+    }
+}
+
+//==============================================================================
+namespace
+{
+    /** The numerator c0 + c1 s + c2 s^2 of each type, over s^2 + R2 s + 1. */
+    void getNumerator(StateVariableTPTFilterType type, double R2, double& c0, double& c1, double& c2) noexcept
+    {
+        using Type = StateVariableTPTFilterType;
+
+        c0 = c1 = c2 = 0.0;
+
+        switch (type)
+        {
+        case Type::LP2:     c0 = 1.0; break;
+        case Type::LP1:     c0 = 1.0; c1 = 1.0; break;
+        case Type::LP2n:    c0 = R2; break;
+        case Type::HP2:     c2 = 1.0; break;
+        case Type::HP1:     c1 = 1.0; c2 = 1.0; break;
+        case Type::HP2n:    c2 = R2; break;
+        case Type::BP2:     c1 = 1.0; break;
+        case Type::BP2n:    c1 = R2; break;
+        case Type::AP2:     c0 = 1.0; c1 = -R2; c2 = 1.0; break;
+        case Type::P2:      c0 = 1.0; c2 = -1.0; break;
+        case Type::N2:      c0 = 1.0; c2 = 1.0; break;
+        default:            c0 = 1.0; break;
+        }
+    }
+
+    /** Multiplies the complex responses in re and im by that of one stage of a
+        type, at the warped frequencies w.
+    */
+    void multiplyByStage(StateVariableTPTFilterType type, double R2, const double* w, double* re, double* im,
+                         size_t numFrequencies) noexcept
+    {
+        double c0, c1, c2;
+        getNumerator(type, R2, c0, c1, c2);
+
+        for (size_t i = 0; i < numFrequencies; ++i)
+        {
+            // N(jw) / D(jw), with D(jw) = 1 - w^2 + j R2 w.
+            const auto w2 = w[i] * w[i];
+            const auto dr = 1.0 - w2, di = R2 * w[i];
+            const auto nr = c0 - c2 * w2, ni = c1 * w[i];
+            const auto scale = 1.0 / (dr * dr + di * di);
+            const auto hr = (nr * dr + ni * di) * scale;
+            const auto hi = (ni * dr - nr * di) * scale;
+
+            const auto r = re[i] * hr - im[i] * hi;
+            im[i] = re[i] * hi + im[i] * hr;
+            re[i] = r;
+        }
+    }
+}
+
+void StateVariableTPTFilterResponse::getMagnitudeAndPhase(const double* frequencies, double* magnitudes, double* phases,
+                                                          size_t numFrequencies) const noexcept
+{
+    jassert(g > 0.0 && numStages > 0 && numStages <= maxNumStages);
+
+    // A chunk at a time, in separate real and imaginary arrays, so that every
+    // loop but the tan and atan2 ones runs on whole SIMD registers.
+    constexpr size_t chunkSize = 64;
+    double w[chunkSize], re[chunkSize], im[chunkSize], morphRe[chunkSize], morphIm[chunkSize];
+
+    const auto piOverSampleRate = juce::MathConstants<double>::pi / sampleRate;
+    const auto maxFrequency = 0.5 * sampleRate * (1.0 - 1.0e-9);
+    const auto oneOverG = 1.0 / g;
+
+    for (size_t start = 0; start < numFrequencies; start += chunkSize)
+    {
+        const auto numInChunk = juce::jmin(chunkSize, numFrequencies - start);
+
+        for (size_t i = 0; i < numInChunk; ++i)
+        {
+            w[i] = std::tan(piOverSampleRate * juce::jlimit(0.0, maxFrequency, frequencies[start + i])) * oneOverG;
+            re[i] = morphRe[i] = 1.0;
+            im[i] = morphIm[i] = 0.0;
+        }
+
+        // The product of the stages for each type, the morph type's only when
+        // it's in play. A cascade blends the two products, as the filter blends
+        // the outputs of the two cascades.
+        const auto morphed = morphProportion > 0.0 && morphType != type;
+
+        for (size_t stage = 0; stage < numStages; ++stage)
+        {
+            multiplyByStage(type, stageR2[stage], w, re, im, numInChunk);
+
+            if (morphed)
+                multiplyByStage(morphType, stageR2[stage], w, morphRe, morphIm, numInChunk);
+        }
+
+        const auto wet = wetMixProportion, dry = 1.0 - wetMixProportion;
+        const auto morph = morphed ? morphProportion : 0.0;
+
+        for (size_t i = 0; i < numInChunk; ++i)
+        {
+            re[i] = dry + (re[i] + (morphRe[i] - re[i]) * morph) * wet;
+            im[i] = (im[i] + (morphIm[i] - im[i]) * morph) * wet;
+        }
+
+        if (magnitudes != nullptr)
+            for (size_t i = 0; i < numInChunk; ++i)
+                magnitudes[start + i] = std::sqrt(re[i] * re[i] + im[i] * im[i]);
+
+        if (phases != nullptr)
+            for (size_t i = 0; i < numInChunk; ++i)
+                phases[start + i] = std::atan2(im[i], re[i]);
+    }
+}
+
+double StateVariableTPTFilterResponse::getMagnitudeForFrequency(double frequency) const noexcept
+{
+    auto magnitude = 0.0;
+    getMagnitudeAndPhase(&frequency, &magnitude, nullptr, 1);
+    return magnitude;
+}
+
+double StateVariableTPTFilterResponse::getPhaseForFrequency(double frequency) const noexcept
+{
+    auto phase = 0.0;
+    getMagnitudeAndPhase(&frequency, nullptr, &phase, 1);
+    return phase;
+}
+
+bool StateVariableTPTFilterResponse::operator== (const StateVariableTPTFilterResponse& other) const noexcept
+{
+    if (type != other.type || morphType != other.morphType || morphProportion != other.morphProportion
+        || sampleRate != other.sampleRate || g != other.g
+        || wetMixProportion != other.wetMixProportion || numStages != other.numStages)
+        return false;
+
+    for (size_t stage = 0; stage < numStages; ++stage)
+        if (stageR2[stage] != other.stageR2[stage])
+            return false;
+
+    return true;
+}
+
+//==============================================================================
+template <typename SampleType, size_t NumChannels>
+StateVariableTPTFilter<SampleType, NumChannels>::StateVariableTPTFilter()
+{
+    cutoffSmoother.setCurrentAndTargetValue(cutoffFrequency);
+    resonanceSmoother.setCurrentAndTargetValue(resonance);
+    mixSmoother.setCurrentAndTargetValue(wetMixProportion);
+    morphSmoother.setCurrentAndTargetValue(morphProportion);
+    typeFadeSmoother.setCurrentAndTargetValue(static_cast<SampleType> (1));
+    driveSmoother.setCurrentAndTargetValue(drive);
+
+    allocate(hasFixedChannels ? NumChannels : 2);
+    updateStages();
+    update();
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::setType(Type newType)
+{
+    if (newType == filterType)
+        return;
+
+    const auto fromWeights = getCurrentWeights();
+    const auto wasCascaded = isCascaded();
+
+    filterType = newType;
+    startTypeFade(fromWeights, wasCascaded);
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::setMorphType(Type newType)
+{
+    if (newType == morphType)
+        return;
+
+    const auto fromWeights = getCurrentWeights();
+    const auto wasCascaded = isCascaded();
+
+    morphType = newType;
+    startTypeFade(fromWeights, wasCascaded);
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::setMorphProportion(SampleType newProportion)
+{
+    jassert(juce::isPositiveAndNotGreaterThan(newProportion, static_cast<SampleType> (1)));
+
+    morphProportion = newProportion;
+    updateCascades();
+
+    if (canMorph())
+    {
+        morphSmoother.setTargetValue(morphProportion);
+        return;
+    }
+
+    // The two types run different stages, so there is nothing to blend.
+    morphSmoother.setCurrentAndTargetValue(morphProportion);
+    clearUnusedStages();
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::setCutoffFrequency(SampleType newCutoffFrequencyHz)
+{
+    jassert(juce::isPositiveAndBelow(newCutoffFrequencyHz, static_cast<SampleType> (sampleRate * 0.5)));
+
+    cutoffFrequency = newCutoffFrequencyHz;
+    cutoffSmoother.setTargetValue(cutoffFrequency);
     update();
 }
 
-template <typename SampleType>
-void StateVariableTPTFilter<SampleType>::setType(Type newType)
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::setResonance(SampleType newResonance)
+{
+    jassert(newResonance > static_cast<SampleType> (0));
+
+    resonance = newResonance;
+    resonanceSmoother.setTargetValue(resonance);
+    update();
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::setCoefficientMode(CoefficientMode newMode)
+{
+    coefficientMode = newMode;
+    update();
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::setRampDurationSeconds(double newDurationSeconds)
+{
+    jassert(newDurationSeconds >= 0.0);
+
+    rampDurationSeconds = newDurationSeconds;
+
+    for (auto* smoother : { &mixSmoother, &morphSmoother, &typeFadeSmoother, &driveSmoother })
+        smoother->reset(sampleRate, rampDurationSeconds);
+
+    cutoffSmoother.reset(sampleRate, rampDurationSeconds);
+    resonanceSmoother.reset(sampleRate, rampDurationSeconds);
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::setWetMixProportion(SampleType newWetMixProportion)
+{
+    jassert(juce::isPositiveAndNotGreaterThan(newWetMixProportion, static_cast<SampleType> (1)));
+
+    wetMixProportion = newWetMixProportion;
+    mixSmoother.setTargetValue(wetMixProportion);
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::setDrive(SampleType newDrive)
+{
+    jassert(newDrive >= static_cast<SampleType> (0));
+
+    // The saturators' last inputs went stale while the filter was linear.
+    if (! isSaturating())
+        for (auto v : { s3, b3 })
+            for (size_t stage = 0; stage < maxNumStages; ++stage)
+                std::fill(v + stage * stateStride, v + stage * stateStride + numStateChannels, static_cast<SampleType> (0));
+
+    drive = newDrive;
+    driveSmoother.setTargetValue(drive);
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::setNumStages(size_t newNumStages)
+{
+    jassert(newNumStages >= 1 && newNumStages <= maxNumStages);
+
+    newNumStages = juce::jlimit(static_cast<size_t> (1), maxNumStages, newNumStages);
+
+    if (newNumStages == numStages)
+        return;
+
+    for (auto v : { s1, s2, s3 })
+        for (auto stage = numStages; stage < newNumStages; ++stage)
+            std::fill(v + stage * stateStride, v + stage * stateStride + numStateChannels, static_cast<SampleType> (0));
+
+    numStages = newNumStages;
+    updateStages();
+    update();
+
+    // The stages in use may no longer match the weights being blended.
+    typeFadeSmoother.setCurrentAndTargetValue(static_cast<SampleType> (1));
+    morphSmoother.setCurrentAndTargetValue(morphProportion);
+    otherCascadeIsLive = false;
+    updateCascades();
+    clearUnusedStages();
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::setAlignment(Alignment newAlignment)
+{
+    alignment = newAlignment;
+    updateStages();
+    update();
+}
+
+//==============================================================================
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    jassert(spec.sampleRate > 0);
+    jassert(spec.numChannels > 0);
+
+    sampleRate = spec.sampleRate;
+    piOverSampleRate = juce::MathConstants<double>::pi / sampleRate;
+
+    allocate(spec.numChannels);
+    allocateScratch();
+
+    for (auto* smoother : { &mixSmoother, &morphSmoother, &typeFadeSmoother, &driveSmoother })
+        smoother->reset(sampleRate, rampDurationSeconds);
+
+    cutoffSmoother.reset(sampleRate, rampDurationSeconds);
+    resonanceSmoother.reset(sampleRate, rampDurationSeconds);
+
+    reset();
+    update();
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::reset()
+{
+    reset(static_cast<SampleType> (0));
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::reset(SampleType newValue)
+{
+    for (auto v : { s1, s2 })
+        for (size_t stage = 0; stage < maxNumStages; ++stage)
+            std::fill(v + stage * stateStride, v + stage * stateStride + numStateChannels, newValue);
+
+    for (size_t stage = 0; stage < maxNumStages; ++stage)
+        std::fill(s3 + stage * stateStride, s3 + stage * stateStride + numStateChannels, static_cast<SampleType> (0));
+
+    // The other cascade starts from silence when it's next needed.
+    otherCascadeIsLive = false;
+
+    cutoffSmoother.setCurrentAndTargetValue(cutoffFrequency);
+    resonanceSmoother.setCurrentAndTargetValue(resonance);
+    mixSmoother.setCurrentAndTargetValue(wetMixProportion);
+    morphSmoother.setCurrentAndTargetValue(morphProportion);
+    typeFadeSmoother.setCurrentAndTargetValue(static_cast<SampleType> (1));
+    driveSmoother.setCurrentAndTargetValue(drive);
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::snapToZero() noexcept
+{
+    for (auto v : { s1, s2, s3, b1, b2, b3 })
+        for (size_t stage = 0; stage < numStages; ++stage)
+            for (size_t channel = 0; channel < numStateChannels; ++channel)
+                juce::dsp::util::snapToZero(v[stage * stateStride + channel]);
+}
+
+template <typename SampleType, size_t NumChannels>
+double StateVariableTPTFilter<SampleType, NumChannels>::getTailLengthSeconds(double decayDecibels) const noexcept
+{
+    // The analog poles of a stage, at g * (-R2 / 2 +- sqrt(R2^2 / 4 - 1)), map to
+    // z = (1 + p) / (1 - p), and the one closest to the unit circle sets how many
+    // decibels the stage decays by per sample.
+    auto seconds = 0.0;
+    const auto stagesToProcess = isCascaded() ? numStages : (size_t) 1;
+
+    for (size_t stage = 0; stage < stagesToProcess; ++stage)
+    {
+        const auto damping = static_cast<double> (isCascaded() ? stageR2[stage] : R2);
+        const auto root = std::sqrt(std::complex<double> (damping * damping * 0.25 - 1.0));
+        auto radius = 0.0;
+
+        for (auto pole : { static_cast<double> (g) * (-damping * 0.5 + root), static_cast<double> (g) * (-damping * 0.5 - root) })
+            radius = juce::jmax(radius, std::abs((1.0 + pole) / (1.0 - pole)));
+
+        const auto decibelsPerSample = -20.0 * std::log10(juce::jlimit(std::numeric_limits<double>::min(), 1.0 - 1.0e-12, radius));
+        seconds += decayDecibels / (decibelsPerSample * sampleRate);
+
+        // Saturating, the integrators' inputs are at most 1 / drive, so a state
+        // above the knee only slews down, by at most 2 g / drive a sample. From
+        // full scale, that's drive / (2 g) samples before the decay above.
+        if (drive > 0)
+            seconds += static_cast<double> (drive) / (2.0 * static_cast<double> (g) * sampleRate);
+    }
+
+    return seconds;
+}
+
+template <typename SampleType, size_t NumChannels>
+StateVariableTPTFilterResponse StateVariableTPTFilter<SampleType, NumChannels>::getResponse() const noexcept
+{
+    static_assert(maxNumStages <= StateVariableTPTFilterResponse::maxNumStages, "Too many stages for the response");
+
+    StateVariableTPTFilterResponse response;
+    response.type = isMorphed() ? filterType : getEffectiveType();
+    response.morphType = isMorphed() ? morphType : response.type;
+    response.morphProportion = isMorphed() ? static_cast<double> (morphProportion) : 0.0;
+    response.sampleRate = sampleRate;
+    response.g = static_cast<double> (g);
+    response.wetMixProportion = static_cast<double> (wetMixProportion);
+    response.numStages = isCascaded() ? numStages : (size_t) 1;
+
+    for (size_t stage = 0; stage < response.numStages; ++stage)
+        response.stageR2[stage] = static_cast<double> (isCascaded() ? stageR2[stage] : R2);
+
+    return response;
+}
+
+template <typename SampleType, size_t NumChannels>
+SampleType StateVariableTPTFilter<SampleType, NumChannels>::getStateMagnitude() const noexcept
+{
+    auto magnitude = static_cast<SampleType> (0);
+    const auto stagesToProcess = isCascaded() ? numStages : (size_t) 1;
+
+    for (auto v : { s1, s2 })
+        for (size_t stage = 0; stage < stagesToProcess; ++stage)
+            for (size_t channel = 0; channel < numStateChannels; ++channel)
+                magnitude = juce::jmax(magnitude, std::abs(v[stage * stateStride + channel]));
+
+    if (otherCascadeIsLive)
+        for (auto v : { b1, b2 })
+            for (size_t stage = 1; stage < stagesToProcess; ++stage)
+                for (size_t channel = 0; channel < numStateChannels; ++channel)
+                    magnitude = juce::jmax(magnitude, std::abs(v[stage * stateStride + channel]));
+
+    return magnitude;
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::allocate(size_t numChannels)
+{
+    numStateChannels = numChannels;
+
+    if (hasFixedChannels)
+    {
+        jassert(numChannels == NumChannels);
+
+        fixedState.fill(static_cast<SampleType> (0));
+        stateStride = numFixedPaddedChannels;
+        s1 = fixedState.data();
+        s2 = s1 + maxNumStages * stateStride;
+        s3 = s2 + maxNumStages * stateStride;
+        b1 = s3 + maxNumStages * stateStride;
+        b2 = b1 + maxNumStages * stateStride;
+        b3 = b2 + maxNumStages * stateStride;
+        return;
+    }
+
+    const auto newStateStride = ((numChannels + numLanes - 1) / numLanes) * numLanes;
+
+    // Preparing again for the same padded channel count, say at a new sample
+    // rate, keeps the existing storage so that it doesn't allocate.
+    if (stateData.getData() != nullptr && newStateStride == stateStride)
+    {
+        std::fill(s1, b3 + maxNumStages * stateStride, static_cast<SampleType> (0));
+        return;
+    }
+
+    stateStride = newStateStride;
+
+    // Whole cache lines of their own, so that filters running on different
+    // threads never write to the same line.
+    const auto numStateBytes = 6 * maxNumStages * stateStride * sizeof(SampleType);
+    stateData.allocate(((numStateBytes + cacheLineSize - 1) / cacheLineSize + 1) * cacheLineSize, true);
+    s1 = getCacheLineAlignedPtr<SampleType>(stateData.getData());
+    s2 = s1 + maxNumStages * stateStride;
+    s3 = s2 + maxNumStages * stateStride;
+    b1 = s3 + maxNumStages * stateStride;
+    b2 = b1 + maxNumStages * stateStride;
+    b3 = b2 + maxNumStages * stateStride;
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::allocateScratch()
+{
+    // Its size doesn't depend on the spec, so preparing again never allocates.
+    if (scratchData.getData() != nullptr)
+        return;
+
+    const auto numScratchSamples = (4 + maxNumStages + 4 + 2) * interleavedBlockSize;
+    const auto numScratchBytes = numInterleavedRegisters * sizeof(SIMDType) + numScratchSamples * sizeof(SampleType);
+    scratchData.allocate(((numScratchBytes + cacheLineSize - 1) / cacheLineSize + 1) * cacheLineSize, true);
+
+    interleaved = getCacheLineAlignedPtr<SIMDType>(scratchData.getData());
+    modulatedG = reinterpret_cast<SampleType*> (interleaved + numInterleavedRegisters);
+    modulatedH = modulatedG + interleavedBlockSize;
+    modulatedR2 = modulatedH + interleavedBlockSize;
+    modulatedMix = modulatedR2 + interleavedBlockSize;
+    modulatedStageH = modulatedMix + interleavedBlockSize;
+    modulatedWeights = modulatedStageH + maxNumStages * interleavedBlockSize;
+    modulatedDrive = modulatedWeights + 4 * interleavedBlockSize;
+    modulatedInverseDrive = modulatedDrive + interleavedBlockSize;
+}
+
+//==============================================================================
+template <typename SampleType, size_t NumChannels>
+typename StateVariableTPTFilter<SampleType, NumChannels>::OutputWeights
+StateVariableTPTFilter<SampleType, NumChannels>::getOutputWeights(Type type) noexcept
+{
+    // The same sums as processFrame(), term by term.
+    enum { input, lowpass, bandpass, highpass };
+    OutputWeights weights;
+    auto& offset = weights.offset;
+    auto& scale = weights.scale;
+    const auto one = static_cast<SampleType> (1);
+
+    switch (type)
+    {
+    case Type::LP2:         offset[lowpass] = one; break;
+    case Type::LP1:         offset[lowpass] = one; offset[bandpass] = one; break;
+    case Type::LP2n:        scale[lowpass] = one; break;
+    case Type::HP2:         offset[highpass] = one; break;
+    case Type::HP1:         offset[highpass] = one; offset[bandpass] = one; break;
+    case Type::HP2n:        scale[highpass] = one; break;
+    case Type::BP2:         offset[bandpass] = one; break;
+    case Type::BP2n:        scale[bandpass] = one; break;
+    case Type::AP2:         offset[input] = one; scale[bandpass] = -2 * one; break;
+    case Type::P2:          offset[lowpass] = one; offset[highpass] = -one; break;
+    case Type::N2:          offset[lowpass] = one; offset[highpass] = one; break;
+    default:                offset[lowpass] = one; break;
+    }
+
+    return weights;
+}
+
+template <typename SampleType, size_t NumChannels>
+typename StateVariableTPTFilter<SampleType, NumChannels>::OutputWeights
+StateVariableTPTFilter<SampleType, NumChannels>::interpolate(const OutputWeights& from, const OutputWeights& to,
+                                                             SampleType proportion) noexcept
+{
+    OutputWeights weights;
+
+    for (size_t output = 0; output < weights.offset.size(); ++output)
+    {
+        weights.offset[output] = from.offset[output] + (to.offset[output] - from.offset[output]) * proportion;
+        weights.scale[output] = from.scale[output] + (to.scale[output] - from.scale[output]) * proportion;
+    }
+
+    return weights;
+}
+
+template <typename SampleType, size_t NumChannels>
+typename StateVariableTPTFilter<SampleType, NumChannels>::OutputWeights
+StateVariableTPTFilter<SampleType, NumChannels>::getTargetWeights(SampleType proportion) const noexcept
+{
+    if (! canMorph())
+        return getOutputWeights(getEffectiveType());
+
+    return interpolate(getOutputWeights(filterType), getOutputWeights(morphType), proportion);
+}
+
+template <typename SampleType, size_t NumChannels>
+typename StateVariableTPTFilter<SampleType, NumChannels>::OutputWeights
+StateVariableTPTFilter<SampleType, NumChannels>::getCurrentWeights() const noexcept
+{
+    const auto target = getTargetWeights(morphSmoother.getCurrentValue());
+
+    return typeFadeSmoother.isSmoothing() ? interpolate(typeFadeWeights, target, typeFadeSmoother.getCurrentValue())
+                                          : target;
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::startTypeFade(const OutputWeights& fromWeights, bool wasCascaded)
+{
+    updateCascades();
+    clearUnusedStages();
+
+    // A crossfade can't span a change in the stages that run, so those switch
+    // at once, as does a change that leaves the output as it was.
+    if (isCascaded() != wasCascaded || getTargetWeights(morphSmoother.getCurrentValue()) == fromWeights)
+    {
+        typeFadeSmoother.setCurrentAndTargetValue(static_cast<SampleType> (1));
+        return;
+    }
+
+    // Each change part way through a crossfade starts from a blend of the last
+    // one, so the weights of types long gone shrink towards denormals.
+    typeFadeWeights = fromWeights;
+
+    for (auto* weights : { &typeFadeWeights.offset, &typeFadeWeights.scale })
+        for (auto& weight : *weights)
+            juce::dsp::util::snapToZero(weight);
+
+    typeFadeSmoother.setCurrentAndTargetValue(static_cast<SampleType> (0));
+    typeFadeSmoother.setTargetValue(static_cast<SampleType> (1));
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::clearUnusedStages() noexcept
+{
+    if (isCascaded())
+        return;
+
+    for (auto v : { s1, s2, s3 })
+        for (size_t stage = 1; stage < numStages; ++stage)
+            std::fill(v + stage * stateStride, v + stage * stateStride + numStateChannels, static_cast<SampleType> (0));
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::updateCascades() noexcept
+{
+    if (! isCascaded())
+    {
+        otherCascadeIsLive = false;
+        return;
+    }
+
+    const auto type = getEffectiveType();
+
+    if (type == cascadeType)
+        return;
+
+    // The first stage is shared, so only the later ones change places. The
+    // cascade that was running carries on as the other one, and the new one
+    // starts from silence unless it was running too.
+    cascadeType = type;
+
+    for (auto v : { std::make_pair(s1, b1), std::make_pair(s2, b2), std::make_pair(s3, b3) })
+        std::swap_ranges(v.first + stateStride, v.first + maxNumStages * stateStride, v.second + stateStride);
+
+    if (! otherCascadeIsLive)
+        for (auto v : { s1, s2, s3 })
+            std::fill(v + stateStride, v + maxNumStages * stateStride, static_cast<SampleType> (0));
+
+    otherCascadeIsLive = true;
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::prepareOtherCascade() noexcept
+{
+    if (otherCascadeIsLive)
+        return;
+
+    for (auto v : { b1, b2, b3 })
+        std::fill(v + stateStride, v + maxNumStages * stateStride, static_cast<SampleType> (0));
+
+    otherCascadeIsLive = true;
+}
+
+//==============================================================================
+template <typename SampleType, size_t NumChannels>
+SampleType StateVariableTPTFilter<SampleType, NumChannels>::processSample(int channel, SampleType inputValue)
+{
+    auto& ls1 = s1[(size_t)channel];
+    auto& ls2 = s2[(size_t)channel];
+
+    if (isMorphed() && isCascaded())
+        prepareOtherCascade();
+    else
+        otherCascadeIsLive = false;
+
+    if (drive > static_cast<SampleType> (0))
+        return processSaturatingSample((size_t)channel, inputValue);
+
+    if (isMorphed())
+        return processWeightedSample((size_t)channel, inputValue);
+
+    const auto type = getEffectiveType();
+
+    if (isCascaded())
+        return type == Type::LP2 ? processCascadeSample<Type::LP2>((size_t)channel, inputValue)
+                                 : processCascadeSample<Type::HP2>((size_t)channel, inputValue);
+
+    switch (type)
+    {
+    case Type::LP2:         return processFrame<Type::LP2>(inputValue, ls1, ls2, g, h, R2);
+    case Type::LP1:         return processFrame<Type::LP1>(inputValue, ls1, ls2, g, h, R2);
+    case Type::LP2n:        return processFrame<Type::LP2n>(inputValue, ls1, ls2, g, h, R2);
+    case Type::HP2:         return processFrame<Type::HP2>(inputValue, ls1, ls2, g, h, R2);
+    case Type::HP1:         return processFrame<Type::HP1>(inputValue, ls1, ls2, g, h, R2);
+    case Type::HP2n:        return processFrame<Type::HP2n>(inputValue, ls1, ls2, g, h, R2);
+    case Type::BP2:         return processFrame<Type::BP2>(inputValue, ls1, ls2, g, h, R2);
+    case Type::BP2n:        return processFrame<Type::BP2n>(inputValue, ls1, ls2, g, h, R2);
+    case Type::AP2:         return processFrame<Type::AP2>(inputValue, ls1, ls2, g, h, R2);
+    case Type::P2:          return processFrame<Type::P2>(inputValue, ls1, ls2, g, h, R2);
+    case Type::N2:          return processFrame<Type::N2>(inputValue, ls1, ls2, g, h, R2);
+    default:                return processFrame<Type::LP2>(inputValue, ls1, ls2, g, h, R2);
+    }
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::processBlock(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                                                                   const juce::dsp::AudioBlock<SampleType>& outputBlock,
+                                                                   const SampleType* cutoffFrequencies) noexcept
+{
+    const auto modulated = cutoffFrequencies != nullptr || isSmoothing();
+    const auto mixed = mixSmoother.isSmoothing() || wetMixProportion < static_cast<SampleType> (1);
+    const auto weighted = isWeighted();
+    const auto saturating = isSaturating();
+    const auto blended = isBlendingCascades(weighted);
+
+    if (blended)
+        prepareOtherCascade();
+    else
+        otherCascadeIsLive = false;
+
+    if (! modulated && ! mixed && ! weighted && ! saturating)
+    {
+        processBlockForType<false, false>(inputBlock, outputBlock, false);
+        return;
+    }
+
+    // Fully dry: the output is the input, so skip the filter and let it start
+    // again from silence once the mix is raised.
+    if (! modulated && ! mixSmoother.isSmoothing() && wetMixProportion == static_cast<SampleType> (0))
+    {
+        if (outputBlock.getNumChannels() > 0 && inputBlock.getChannelPointer(0) != outputBlock.getChannelPointer(0))
+            outputBlock.copyFrom(inputBlock);
+
+        for (auto v : { s1, s2, s3 })
+            for (size_t stage = 0; stage < numStages; ++stage)
+                std::fill(v + stage * stateStride, v + stage * stateStride + numStateChannels, static_cast<SampleType> (0));
+
+        otherCascadeIsLive = false;
+
+        // Nor can a change of type or drive be heard, so they're done.
+        morphSmoother.setCurrentAndTargetValue(morphProportion);
+        typeFadeSmoother.setCurrentAndTargetValue(static_cast<SampleType> (1));
+        driveSmoother.setCurrentAndTargetValue(drive);
+        return;
+    }
+
+    const auto numSamples = outputBlock.getNumSamples();
+
+    for (size_t start = 0; start < numSamples; start += interleavedBlockSize)
+    {
+        const auto numFrames = juce::jmin(interleavedBlockSize, numSamples - start);
+        const auto subInputBlock = inputBlock.getSubBlock(start, numFrames);
+        const auto subOutputBlock = outputBlock.getSubBlock(start, numFrames);
+
+        if (modulated)
+            updateModulation(cutoffFrequencies != nullptr ? cutoffFrequencies + start : nullptr, numFrames);
+        else if (saturating)
+            fillModulation(numFrames);
+
+        if (mixed || saturating)
+            updateMix(numFrames);
+
+        if (weighted || saturating)
+            updateWeights(numFrames, modulated);
+
+        if (saturating)
+        {
+            updateDrive(numFrames);
+            processSaturatingBlock(subInputBlock, subOutputBlock, blended);
+        }
+        else if (modulated && mixed)
+            processBlockForType<true, true>(subInputBlock, subOutputBlock, weighted);
+        else if (modulated)
+            processBlockForType<true, false>(subInputBlock, subOutputBlock, weighted);
+        else if (mixed)
+            processBlockForType<false, true>(subInputBlock, subOutputBlock, weighted);
+        else
+            processBlockForType<false, false>(subInputBlock, subOutputBlock, weighted);
+    }
+
+    if (cutoffFrequencies != nullptr && numSamples > 0)
+    {
+        cutoffFrequency = cutoffFrequencies[numSamples - 1];
+        cutoffSmoother.setCurrentAndTargetValue(cutoffFrequency);
+        update();
+    }
+}
+
+template <typename SampleType, size_t NumChannels>
+template <bool modulated, bool mixed>
+void StateVariableTPTFilter<SampleType, NumChannels>::processBlockForType(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                                                                          const juce::dsp::AudioBlock<SampleType>& outputBlock,
+                                                                          bool weighted) noexcept
+{
+    // The weights make up the output whatever the type, and every type in play
+    // runs the same stages. A cascade runs as the effective type, whose stages
+    // are the ones in s1 and s2, see updateCascades().
+    if (weighted)
+    {
+        if (isCascaded() && getEffectiveType() == Type::HP2)
+            processBlockForStages<Type::HP2, modulated, mixed, true>(inputBlock, outputBlock);
+        else if (isCascaded())
+            processBlockForStages<Type::LP2, modulated, mixed, true>(inputBlock, outputBlock);
+        else
+            processBlock<Type::LP2, 1, modulated, mixed, true>(inputBlock, outputBlock);
+
+        return;
+    }
+
+    switch (getEffectiveType())
+    {
+    case Type::LP2:         processBlockForStages<Type::LP2, modulated, mixed, false>(inputBlock, outputBlock); break;
+    case Type::LP1:         processBlock<Type::LP1, 1, modulated, mixed, false>(inputBlock, outputBlock); break;
+    case Type::LP2n:        processBlock<Type::LP2n, 1, modulated, mixed, false>(inputBlock, outputBlock); break;
+    case Type::HP2:         processBlockForStages<Type::HP2, modulated, mixed, false>(inputBlock, outputBlock); break;
+    case Type::HP1:         processBlock<Type::HP1, 1, modulated, mixed, false>(inputBlock, outputBlock); break;
+    case Type::HP2n:        processBlock<Type::HP2n, 1, modulated, mixed, false>(inputBlock, outputBlock); break;
+    case Type::BP2:         processBlock<Type::BP2, 1, modulated, mixed, false>(inputBlock, outputBlock); break;
+    case Type::BP2n:        processBlock<Type::BP2n, 1, modulated, mixed, false>(inputBlock, outputBlock); break;
+    case Type::AP2:         processBlock<Type::AP2, 1, modulated, mixed, false>(inputBlock, outputBlock); break;
+    case Type::P2:          processBlock<Type::P2, 1, modulated, mixed, false>(inputBlock, outputBlock); break;
+    case Type::N2:          processBlock<Type::N2, 1, modulated, mixed, false>(inputBlock, outputBlock); break;
+    default:                processBlockForStages<Type::LP2, modulated, mixed, false>(inputBlock, outputBlock); break;
+    }
+}
+
+template <typename SampleType, size_t NumChannels>
+template <StateVariableTPTFilterType type, bool modulated, bool mixed, bool weighted>
+void StateVariableTPTFilter<SampleType, NumChannels>::processBlockForStages(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                                                                            const juce::dsp::AudioBlock<SampleType>& outputBlock) noexcept
+{
+    switch (numStages)
+    {
+    case 2:     processBlock<type, 2, modulated, mixed, weighted>(inputBlock, outputBlock); break;
+    case 3:     processBlock<type, 3, modulated, mixed, weighted>(inputBlock, outputBlock); break;
+    case 4:     processBlock<type, 4, modulated, mixed, weighted>(inputBlock, outputBlock); break;
+    default:    processBlock<type, 1, modulated, mixed, weighted>(inputBlock, outputBlock); break;
+    }
+}
+
+template <typename SampleType, size_t NumChannels>
+template <StateVariableTPTFilterType type, size_t numStagesToProcess, bool modulated, bool mixed, bool weighted>
+void StateVariableTPTFilter<SampleType, NumChannels>::processBlock(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                                                                   const juce::dsp::AudioBlock<SampleType>& outputBlock) noexcept
+{
+    const auto numChannels = hasFixedChannels ? NumChannels : outputBlock.getNumChannels();
+    const auto numSamples = outputBlock.getNumSamples();
+
+    jassert(! (modulated || mixed || weighted) || numSamples <= interleavedBlockSize);
+
+    for (size_t firstChannel = 0; firstChannel < numChannels;)
+    {
+        // Wide buses advance two groups of channels per frame.
+        if (canPairGroups && numChannels - firstChannel >= 2 * numLanes)
+        {
+            processInterleaved<type, numStagesToProcess, modulated, mixed, weighted, SIMDPair>(inputBlock, outputBlock,
+                                                                                              firstChannel, 2 * numLanes);
+            firstChannel += 2 * numLanes;
+            continue;
+        }
+
+        const auto numGroupChannels = juce::jmin(numLanes, numChannels - firstChannel);
+
+        // A lone channel gains nothing from interleaving, so run it in place.
+        if (numGroupChannels == 1)
+        {
+            if (numStagesToProcess == 1)
+                processFrames<type, modulated, mixed, weighted>(inputBlock.getChannelPointer(firstChannel),
+                                                                outputBlock.getChannelPointer(firstChannel),
+                                                                numSamples, s1[firstChannel], s2[firstChannel]);
+            else
+                processCascadeFrames<type, numStagesToProcess, modulated, mixed, weighted>(inputBlock.getChannelPointer(firstChannel),
+                                                                                           outputBlock.getChannelPointer(firstChannel),
+                                                                                           numSamples, s1 + firstChannel, s2 + firstChannel,
+                                                                                           b1 + firstChannel, b2 + firstChannel);
+        }
+        else
+        {
+            processInterleaved<type, numStagesToProcess, modulated, mixed, weighted, SIMDType>(inputBlock, outputBlock,
+                                                                                              firstChannel, numGroupChannels);
+        }
+
+        firstChannel += numLanes;
+    }
+}
+
+template <typename SampleType, size_t NumChannels>
+template <StateVariableTPTFilterType type, size_t numStagesToProcess, bool modulated, bool mixed, bool weighted, typename VecType>
+void StateVariableTPTFilter<SampleType, NumChannels>::processInterleaved(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                                                                        const juce::dsp::AudioBlock<SampleType>& outputBlock,
+                                                                        size_t firstChannel, size_t numGroupChannels) noexcept
 {
-    filterType = newType;
+    constexpr auto frameWidth = sizeof(VecType) / sizeof(SampleType);
+    jassert(frameWidth * interleavedBlockSize <= numLanes * numInterleavedRegisters);
+
+    const auto numSamples = outputBlock.getNumSamples();
+    auto& state1 = *reinterpret_cast<VecType*> (s1 + firstChannel);
+    auto& state2 = *reinterpret_cast<VecType*> (s2 + firstChannel);
+    auto* frames = reinterpret_cast<VecType*> (interleaved);
+    auto* samples = reinterpret_cast<SampleType*> (frames);
+
+    for (size_t start = 0; start < numSamples; start += interleavedBlockSize)
+    {
+        const auto numFrames = juce::jmin(interleavedBlockSize, numSamples - start);
+
+        interleave<frameWidth>(inputBlock, firstChannel, numGroupChannels, start, numFrames, samples);
+
+        if (numStagesToProcess == 1)
+            processFrames<type, modulated, mixed, weighted>(frames, frames, numFrames, state1, state2);
+        else
+            processCascadeFrames<type, numStagesToProcess, modulated, mixed, weighted>(frames, frames, numFrames,
+                                                                                       s1 + firstChannel, s2 + firstChannel,
+                                                                                       b1 + firstChannel, b2 + firstChannel);
+
+        deinterleave<frameWidth>(samples, outputBlock, firstChannel, numGroupChannels, start, numFrames);
+    }
 }
 
-template <typename SampleType>
-void StateVariableTPTFilter<SampleType>::setCutoffFrequency(SampleType newCutoffFrequencyHz)
+template <typename SampleType, size_t NumChannels>
+template <size_t frameWidth>
+void StateVariableTPTFilter<SampleType, NumChannels>::interleave(const juce::dsp::AudioBlock<const SampleType>& block,
+                                                                 size_t firstChannel, size_t numGroupChannels,
+                                                                 size_t start, size_t numFrames,
+                                                                 SampleType* samples) noexcept
 {
-    jassert(juce::isPositiveAndBelow(newCutoffFrequencyHz, static_cast<SampleType> (sampleRate * 0.5)));
+    for (size_t lane = 0; lane < frameWidth; ++lane)
+    {
+        if (lane < numGroupChannels)
+        {
+            const auto* src = block.getChannelPointer(firstChannel + lane) + start;
 
-    cutoffFrequency = newCutoffFrequencyHz;
-    update();
+            for (size_t i = 0; i < numFrames; ++i)
+                samples[i * frameWidth + lane] = src[i];
+        }
+        else
+        {
+            for (size_t i = 0; i < numFrames; ++i)
+                samples[i * frameWidth + lane] = static_cast<SampleType> (0);
+        }
+    }
 }
 
-template <typename SampleType>
-void StateVariableTPTFilter<SampleType>::setResonance(SampleType newResonance)
+template <typename SampleType, size_t NumChannels>
+template <size_t frameWidth>
+void StateVariableTPTFilter<SampleType, NumChannels>::deinterleave(const SampleType* samples,
+                                                                   const juce::dsp::AudioBlock<SampleType>& block,
+                                                                   size_t firstChannel, size_t numGroupChannels,
+                                                                   size_t start, size_t numFrames) noexcept
 {
-    jassert(newResonance > static_cast<SampleType> (0));
+    for (size_t lane = 0; lane < numGroupChannels; ++lane)
+    {
+        auto* dst = block.getChannelPointer(firstChannel + lane) + start;
 
-    resonance = newResonance;
-    update();
+        for (size_t i = 0; i < numFrames; ++i)
+            dst[i] = samples[i * frameWidth + lane];
+    }
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::processSaturatingBlock(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                                                                             const juce::dsp::AudioBlock<SampleType>& outputBlock,
+                                                                             bool blended) noexcept
+{
+    switch (isCascaded() ? numStages : (size_t) 1)
+    {
+    case 2:     blended ? processSaturatingStages<2, true>(inputBlock, outputBlock) : processSaturatingStages<2, false>(inputBlock, outputBlock); break;
+    case 3:     blended ? processSaturatingStages<3, true>(inputBlock, outputBlock) : processSaturatingStages<3, false>(inputBlock, outputBlock); break;
+    case 4:     blended ? processSaturatingStages<4, true>(inputBlock, outputBlock) : processSaturatingStages<4, false>(inputBlock, outputBlock); break;
+    default:    processSaturatingStages<1, false>(inputBlock, outputBlock); break;
+    }
+}
+
+template <typename SampleType, size_t NumChannels>
+template <size_t numStagesToProcess, bool blended>
+void StateVariableTPTFilter<SampleType, NumChannels>::processSaturatingStages(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                                                                              const juce::dsp::AudioBlock<SampleType>& outputBlock) noexcept
+{
+    const auto numChannels = hasFixedChannels ? NumChannels : outputBlock.getNumChannels();
+    const auto numFrames = outputBlock.getNumSamples();
+    auto* samples = reinterpret_cast<SampleType*> (interleaved);
+
+    jassert(numFrames <= interleavedBlockSize);
+
+    // The same groups of channels as the linear kernels.
+    for (size_t firstChannel = 0; firstChannel < numChannels;)
+    {
+        if (canPairGroups && numChannels - firstChannel >= 2 * numLanes)
+        {
+            interleave<2 * numLanes>(inputBlock, firstChannel, 2 * numLanes, 0, numFrames, samples);
+            processSaturatingFrames<numStagesToProcess, blended, 2 * numLanes>(samples, samples, numFrames, firstChannel);
+            deinterleave<2 * numLanes>(samples, outputBlock, firstChannel, 2 * numLanes, 0, numFrames);
+            firstChannel += 2 * numLanes;
+            continue;
+        }
+
+        const auto numGroupChannels = juce::jmin(numLanes, numChannels - firstChannel);
+
+        if (numGroupChannels == 1)
+        {
+            processSaturatingFrames<numStagesToProcess, blended, 1>(inputBlock.getChannelPointer(firstChannel),
+                                                           outputBlock.getChannelPointer(firstChannel),
+                                                           numFrames, firstChannel);
+        }
+        else
+        {
+            interleave<numLanes>(inputBlock, firstChannel, numGroupChannels, 0, numFrames, samples);
+            processSaturatingFrames<numStagesToProcess, blended, numLanes>(samples, samples, numFrames, firstChannel);
+            deinterleave<numLanes>(samples, outputBlock, firstChannel, numGroupChannels, 0, numFrames);
+        }
+
+        firstChannel += numLanes;
+    }
 }
 
 //==============================================================================
-template <typename SampleType>
-void StateVariableTPTFilter<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::processMultiOutput(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                                                                         const juce::dsp::AudioBlock<SampleType>& lowpassBlock,
+                                                                         const juce::dsp::AudioBlock<SampleType>& bandpassBlock,
+                                                                         const juce::dsp::AudioBlock<SampleType>& highpassBlock) noexcept
 {
-    jassert(spec.sampleRate > 0);
-    jassert(spec.numChannels > 0);
+    jassert(inputBlock.getNumChannels() <= numStateChannels);
+    jassert(! hasFixedChannels || inputBlock.getNumChannels() == NumChannels);
 
-    sampleRate = spec.sampleRate;
+    for (auto* block : { &lowpassBlock, &bandpassBlock, &highpassBlock })
+    {
+        juce::ignoreUnused(block);
+        jassert(block->getNumChannels() == 0 || block->getNumChannels() == inputBlock.getNumChannels());
+        jassert(block->getNumChannels() == 0 || block->getNumSamples() == inputBlock.getNumSamples());
+    }
 
-    s1.resize(spec.numChannels);
-    s2.resize(spec.numChannels);
+    const auto outputs = (lowpassBlock.getNumChannels() > 0 ? 1 : 0)
+                       | (bandpassBlock.getNumChannels() > 0 ? 2 : 0)
+                       | (highpassBlock.getNumChannels() > 0 ? 4 : 0);
 
-    reset();
-    update();
+    if (! isSmoothing())
+    {
+        processMultiOutputForOutputs<false>(outputs, inputBlock, lowpassBlock, bandpassBlock, highpassBlock);
+    }
+    else
+    {
+        const auto numSamples = inputBlock.getNumSamples();
+
+        for (size_t start = 0; start < numSamples; start += interleavedBlockSize)
+        {
+            const auto numFrames = juce::jmin(interleavedBlockSize, numSamples - start);
+
+            updateModulation(nullptr, numFrames);
+
+            processMultiOutputForOutputs<true>(outputs, inputBlock.getSubBlock(start, numFrames),
+                                               lowpassBlock.getNumChannels() > 0 ? lowpassBlock.getSubBlock(start, numFrames) : lowpassBlock,
+                                               bandpassBlock.getNumChannels() > 0 ? bandpassBlock.getSubBlock(start, numFrames) : bandpassBlock,
+                                               highpassBlock.getNumChannels() > 0 ? highpassBlock.getSubBlock(start, numFrames) : highpassBlock);
+        }
+    }
+
+#if JUCE_DSP_ENABLE_SNAP_TO_ZERO
+    snapToZero();
+#endif
 }
 
-template <typename SampleType>
-void StateVariableTPTFilter<SampleType>::reset()
+template <typename SampleType, size_t NumChannels>
+template <bool modulated>
+void StateVariableTPTFilter<SampleType, NumChannels>::processMultiOutputForOutputs(int outputs,
+                                                                                   const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                                                                                   const juce::dsp::AudioBlock<SampleType>& lowpassBlock,
+                                                                                   const juce::dsp::AudioBlock<SampleType>& bandpassBlock,
+                                                                                   const juce::dsp::AudioBlock<SampleType>& highpassBlock) noexcept
 {
-    reset(static_cast<SampleType> (0));
+    switch (outputs)
+    {
+    case 1:     processMultiOutputBlock<modulated, true,  false, false>(inputBlock, lowpassBlock, bandpassBlock, highpassBlock); break;
+    case 2:     processMultiOutputBlock<modulated, false, true,  false>(inputBlock, lowpassBlock, bandpassBlock, highpassBlock); break;
+    case 3:     processMultiOutputBlock<modulated, true,  true,  false>(inputBlock, lowpassBlock, bandpassBlock, highpassBlock); break;
+    case 4:     processMultiOutputBlock<modulated, false, false, true >(inputBlock, lowpassBlock, bandpassBlock, highpassBlock); break;
+    case 5:     processMultiOutputBlock<modulated, true,  false, true >(inputBlock, lowpassBlock, bandpassBlock, highpassBlock); break;
+    case 6:     processMultiOutputBlock<modulated, false, true,  true >(inputBlock, lowpassBlock, bandpassBlock, highpassBlock); break;
+    case 7:     processMultiOutputBlock<modulated, true,  true,  true >(inputBlock, lowpassBlock, bandpassBlock, highpassBlock); break;
+    default:    break;
+    }
+}
+
+template <typename SampleType, size_t NumChannels>
+template <bool modulated, bool writeLP, bool writeBP, bool writeHP>
+void StateVariableTPTFilter<SampleType, NumChannels>::processMultiOutputBlock(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                                                                              const juce::dsp::AudioBlock<SampleType>& lowpassBlock,
+                                                                              const juce::dsp::AudioBlock<SampleType>& bandpassBlock,
+                                                                              const juce::dsp::AudioBlock<SampleType>& highpassBlock) noexcept
+{
+    const auto numChannels = hasFixedChannels ? NumChannels : inputBlock.getNumChannels();
+    const auto numSamples = inputBlock.getNumSamples();
+
+    jassert(! modulated || numSamples <= interleavedBlockSize);
+
+    for (size_t firstChannel = 0; firstChannel < numChannels; firstChannel += numLanes)
+    {
+        const auto numGroupChannels = juce::jmin(numLanes, numChannels - firstChannel);
+
+        if (numGroupChannels == 1)
+        {
+            processFramesMultiOutput<modulated, writeLP, writeBP, writeHP>(inputBlock.getChannelPointer(firstChannel),
+                                                                           writeLP ? lowpassBlock.getChannelPointer(firstChannel) : nullptr,
+                                                                           writeBP ? bandpassBlock.getChannelPointer(firstChannel) : nullptr,
+                                                                           writeHP ? highpassBlock.getChannelPointer(firstChannel) : nullptr,
+                                                                           numSamples, s1[firstChannel], s2[firstChannel]);
+            continue;
+        }
+
+        auto& state1 = *reinterpret_cast<SIMDType*> (s1 + firstChannel);
+        auto& state2 = *reinterpret_cast<SIMDType*> (s2 + firstChannel);
+
+        // The lowpass output overwrites the input frames, the other two get their own thirds.
+        auto* frames = interleaved;
+        auto* bandpassFrames = frames + interleavedBlockSize;
+        auto* highpassFrames = bandpassFrames + interleavedBlockSize;
+
+        for (size_t start = 0; start < numSamples; start += interleavedBlockSize)
+        {
+            const auto numFrames = juce::jmin(interleavedBlockSize, numSamples - start);
+
+            interleave<numLanes>(inputBlock, firstChannel, numGroupChannels, start, numFrames, reinterpret_cast<SampleType*> (frames));
+            processFramesMultiOutput<modulated, writeLP, writeBP, writeHP>(frames, frames, bandpassFrames, highpassFrames,
+                                                                           numFrames, state1, state2);
+
+            if (writeLP)
+                deinterleave<numLanes>(reinterpret_cast<SampleType*> (frames), lowpassBlock, firstChannel, numGroupChannels, start, numFrames);
+
+            if (writeBP)
+                deinterleave<numLanes>(reinterpret_cast<SampleType*> (bandpassFrames), bandpassBlock, firstChannel, numGroupChannels, start, numFrames);
+
+            if (writeHP)
+                deinterleave<numLanes>(reinterpret_cast<SampleType*> (highpassFrames), highpassBlock, firstChannel, numGroupChannels, start, numFrames);
+        }
+    }
+}
+
+template <typename SampleType, size_t NumChannels>
+template <StateVariableTPTFilterType type, bool modulated, bool mixed, bool weighted, typename VecType>
+void StateVariableTPTFilter<SampleType, NumChannels>::processFrames(const VecType* input, VecType* output, size_t numFrames,
+                                                                    VecType& state1, VecType& state2) const noexcept
+{
+    // Local copies, so that writing the output can't force the compiler to reload them.
+    const auto lg = g, lh = h, lR2 = R2;
+    const auto* mg = modulatedG;
+    const auto* mh = modulatedH;
+    const auto* mR2 = modulatedR2;
+    const auto* mMix = modulatedMix;
+    const auto* wInput = modulatedWeights;
+    const auto* wLP = wInput + interleavedBlockSize;
+    const auto* wBP = wLP + interleavedBlockSize;
+    const auto* wHP = wBP + interleavedBlockSize;
+    auto ls1 = state1;
+    auto ls2 = state2;
+
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        const auto x = input[i];
+        const auto y = weighted ? processWeightedFrame(x, ls1, ls2, modulated ? mg[i] : lg, modulated ? mh[i] : lh,
+                                                       modulated ? mR2[i] : lR2, wInput[i], wLP[i], wBP[i], wHP[i])
+                     : modulated ? processFrame<type>(x, ls1, ls2, mg[i], mh[i], mR2[i])
+                                 : processFrame<type>(x, ls1, ls2, lg, lh, lR2);
+
+        // dry * (1 - mix) + wet * mix
+        output[i] = mixed ? x + (y - x) * mMix[i] : y;
+    }
+
+    state1 = ls1;
+    state2 = ls2;
+}
+
+template <typename SampleType, size_t NumChannels>
+template <StateVariableTPTFilterType type, size_t numStagesToProcess, bool modulated, bool mixed, bool weighted, typename VecType>
+void StateVariableTPTFilter<SampleType, NumChannels>::processCascadeFrames(const VecType* input, VecType* output, size_t numFrames,
+                                                                           SampleType* state1, SampleType* state2,
+                                                                           SampleType* otherState1, SampleType* otherState2) const noexcept
+{
+    // The cascade of the other cascading type, whose output blends with this one's.
+    constexpr auto otherType = type == Type::LP2 ? Type::HP2 : Type::LP2;
+
+    const auto lg = g;
+    const auto* mg = modulatedG;
+    const auto* mR2 = modulatedR2;
+    const auto* mMix = modulatedMix;
+    const auto* wInput = modulatedWeights;
+    const auto* wLP = wInput + interleavedBlockSize;
+    const auto* wBP = wLP + interleavedBlockSize;
+    const auto* wHP = wBP + interleavedBlockSize;
+    SampleType lh[numStagesToProcess], lR2[numStagesToProcess], lR2Offset[numStagesToProcess], lR2Scale[numStagesToProcess];
+    VecType ls1[numStagesToProcess], ls2[numStagesToProcess], lb1[numStagesToProcess], lb2[numStagesToProcess];
+
+    juce::ignoreUnused(wInput, wBP);
+
+    for (size_t stage = 0; stage < numStagesToProcess; ++stage)
+    {
+        lh[stage] = stageH[stage];
+        lR2[stage] = stageR2[stage];
+        lR2Offset[stage] = stageR2Offset[stage];
+        lR2Scale[stage] = stageR2Scale[stage];
+        ls1[stage] = *reinterpret_cast<const VecType*> (state1 + stage * stateStride);
+        ls2[stage] = *reinterpret_cast<const VecType*> (state2 + stage * stateStride);
+
+        if (weighted && stage > 0)
+        {
+            lb1[stage] = *reinterpret_cast<const VecType*> (otherState1 + stage * stateStride);
+            lb2[stage] = *reinterpret_cast<const VecType*> (otherState2 + stage * stateStride);
+        }
+    }
+
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        const auto x = input[i];
+        auto y = x;
+
+        if (weighted)
+        {
+            // Only LP2 and HP2 cascade, so the weights in play are those of the
+            // lowpass and the highpass. The first stage gives both, and each
+            // cascade then runs its own later stages.
+            const auto fg = modulated ? mg[i] : lg;
+            VecType yLP, yBP, yHP;
+
+            processCore(x, ls1[0], ls2[0], fg,
+                        modulated ? modulatedStageH[i] : lh[0],
+                        modulated ? lR2Offset[0] + lR2Scale[0] * mR2[i] : lR2[0],
+                        yLP, yBP, yHP);
+
+            auto yThis = type == Type::LP2 ? yLP : yHP;
+            auto yOther = type == Type::LP2 ? yHP : yLP;
+
+            for (size_t stage = 1; stage < numStagesToProcess; ++stage)
+            {
+                const auto fh = modulated ? modulatedStageH[stage * interleavedBlockSize + i] : lh[stage];
+                const auto fR2 = modulated ? lR2Offset[stage] + lR2Scale[stage] * mR2[i] : lR2[stage];
+
+                yThis = processFrame<type>(yThis, ls1[stage], ls2[stage], fg, fh, fR2);
+                yOther = processFrame<otherType>(yOther, lb1[stage], lb2[stage], fg, fh, fR2);
+            }
+
+            y = type == Type::LP2 ? yThis * wLP[i] + yOther * wHP[i]
+                                  : yOther * wLP[i] + yThis * wHP[i];
+        }
+        else
+        {
+            for (size_t stage = 0; stage < numStagesToProcess; ++stage)
+            {
+                const auto fg = modulated ? mg[i] : lg;
+                const auto fh = modulated ? modulatedStageH[stage * interleavedBlockSize + i] : lh[stage];
+                const auto fR2 = modulated ? lR2Offset[stage] + lR2Scale[stage] * mR2[i] : lR2[stage];
+
+                y = processFrame<type>(y, ls1[stage], ls2[stage], fg, fh, fR2);
+            }
+        }
+
+        output[i] = mixed ? x + (y - x) * mMix[i] : y;
+    }
+
+    for (size_t stage = 0; stage < numStagesToProcess; ++stage)
+    {
+        *reinterpret_cast<VecType*> (state1 + stage * stateStride) = ls1[stage];
+        *reinterpret_cast<VecType*> (state2 + stage * stateStride) = ls2[stage];
+
+        if (weighted && stage > 0)
+        {
+            *reinterpret_cast<VecType*> (otherState1 + stage * stateStride) = lb1[stage];
+            *reinterpret_cast<VecType*> (otherState2 + stage * stateStride) = lb2[stage];
+        }
+    }
 }
 
-template <typename SampleType>
-void StateVariableTPTFilter<SampleType>::reset(SampleType newValue)
+template <typename SampleType, size_t NumChannels>
+template <StateVariableTPTFilterType type>
+SampleType StateVariableTPTFilter<SampleType, NumChannels>::processCascadeSample(size_t channel, SampleType inputValue) noexcept
 {
-    for (auto v : { &s1, &s2 })
-        std::fill(v->begin(), v->end(), newValue);
+    auto y = inputValue;
+
+    for (size_t stage = 0; stage < numStages; ++stage)
+        y = processFrame<type>(y, s1[stage * stateStride + channel], s2[stage * stateStride + channel],
+                               g, stageH[stage], stageR2[stage]);
+
+    return y;
 }
 
-template <typename SampleType>
-void StateVariableTPTFilter<SampleType>::snapToZero() noexcept
+template <typename SampleType, size_t NumChannels>
+SampleType StateVariableTPTFilter<SampleType, NumChannels>::processWeightedSample(size_t channel, SampleType inputValue) noexcept
 {
-    for (auto v : { &s1, &s2 })
-        for (auto& element : *v)
-            juce::dsp::util::snapToZero(element);
+    const auto weights = getTargetWeights(morphProportion);
+    const auto cascaded = isCascaded();
+    const auto stagesToProcess = cascaded ? numStages : (size_t) 1;
+    auto y = inputValue;
+
+    // A morph between the two cascades blends their outputs, as in processCascadeFrames().
+    if (cascaded)
+    {
+        const auto lowpassFirst = getEffectiveType() == Type::LP2;
+        SampleType yLP, yBP, yHP;
+
+        processCore(y, s1[channel], s2[channel], g, stageH[0], stageR2[0], yLP, yBP, yHP);
+
+        for (size_t stage = 1; stage < stagesToProcess; ++stage)
+        {
+            const auto index = stage * stateStride + channel;
+            yLP = processFrame<Type::LP2>(yLP, lowpassFirst ? s1[index] : b1[index], lowpassFirst ? s2[index] : b2[index],
+                                          g, stageH[stage], stageR2[stage]);
+            yHP = processFrame<Type::HP2>(yHP, lowpassFirst ? b1[index] : s1[index], lowpassFirst ? b2[index] : s2[index],
+                                          g, stageH[stage], stageR2[stage]);
+        }
+
+        return yLP * weights.get(1, stageR2[0]) + yHP * weights.get(3, stageR2[0]);
+    }
+
+    for (size_t stage = 0; stage < stagesToProcess; ++stage)
+    {
+        const auto damping = cascaded ? stageR2[stage] : R2;
+
+        y = processWeightedFrame(y, s1[stage * stateStride + channel], s2[stage * stateStride + channel],
+                                 g, cascaded ? stageH[stage] : h, damping,
+                                 weights.get(0, damping), weights.get(1, damping), weights.get(2, damping), weights.get(3, damping));
+    }
+
+    return y;
 }
 
-//==============================================================================
-template <typename SampleType>
-SampleType StateVariableTPTFilter<SampleType>::processSample(int channel, SampleType inputValue)
+template <typename SampleType, size_t NumChannels>
+template <bool modulated, bool writeLP, bool writeBP, bool writeHP, typename VecType>
+void StateVariableTPTFilter<SampleType, NumChannels>::processFramesMultiOutput(const VecType* input,
+                                                                               VecType* lowpass, VecType* bandpass, VecType* highpass,
+                                                                               size_t numFrames, VecType& state1, VecType& state2) const noexcept
 {
-    auto& ls1 = s1[(size_t)channel];
-    auto& ls2 = s2[(size_t)channel];
+    const auto lg = g, lh = h, lR2 = R2;
+    const auto* mg = modulatedG;
+    const auto* mh = modulatedH;
+    const auto* mR2 = modulatedR2;
+    auto ls1 = state1;
+    auto ls2 = state2;
+
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        const auto fR2 = modulated ? mR2[i] : lR2;
+        VecType yLP, yBP, yHP;
+
+        processCore(input[i], ls1, ls2, modulated ? mg[i] : lg, modulated ? mh[i] : lh, fR2, yLP, yBP, yHP);
+
+        if (writeLP)
+            lowpass[i] = yLP;
+
+        if (writeBP)
+            bandpass[i] = yBP * fR2;
 
-    auto yHP = h * (inputValue - ls1 * (g + R2) - ls2);
+        if (writeHP)
+            highpass[i] = yHP;
+    }
+
+    state1 = ls1;
+    state2 = ls2;
+}
+
+template <typename SampleType, size_t NumChannels>
+template <typename VecType>
+void StateVariableTPTFilter<SampleType, NumChannels>::processCore(VecType inputValue, VecType& ls1, VecType& ls2,
+                                                                  SampleType g, SampleType h, SampleType R2,
+                                                                  VecType& yLP, VecType& yBP, VecType& yHP) noexcept
+{
+    // Scalars always sit on the right hand side so that this also works on SIMDRegister.
+    yHP = (inputValue - ls1 * (g + R2) - ls2) * h;
 
-    auto yBP = yHP * g + ls1;
+    yBP = yHP * g + ls1;
     ls1 = yHP * g + yBP;
 
-    auto yLP = yBP * g + ls2;
+    yLP = yBP * g + ls2;
     ls2 = yBP * g + yLP;
+}
+
+template <typename SampleType, size_t NumChannels>
+template <StateVariableTPTFilterType type, typename VecType>
+VecType StateVariableTPTFilter<SampleType, NumChannels>::processFrame(VecType inputValue, VecType& ls1, VecType& ls2,
+                                                                      SampleType g, SampleType h, SampleType R2) noexcept
+{
+    VecType yLP, yBP, yHP;
+    processCore(inputValue, ls1, ls2, g, h, R2, yLP, yBP, yHP);
 
-    switch (filterType)
+    // The type is a template argument, so this switch folds away at compile time.
+    switch (type)
     {
     case Type::LP2:         return (yLP);
     case Type::LP1:         return (yLP + yBP);
@@ -126,15 +1499,418 @@ SampleType StateVariableTPTFilter<SampleType>::processSample(int channel, Sample
     }*/
 }
 
+template <typename SampleType, size_t NumChannels>
+template <typename VecType>
+VecType StateVariableTPTFilter<SampleType, NumChannels>::processWeightedFrame(VecType inputValue, VecType& ls1, VecType& ls2,
+                                                                              SampleType g, SampleType h, SampleType R2,
+                                                                              SampleType wInput, SampleType wLP,
+                                                                              SampleType wBP, SampleType wHP) noexcept
+{
+    VecType yLP, yBP, yHP;
+    processCore(inputValue, ls1, ls2, g, h, R2, yLP, yBP, yHP);
+
+    return inputValue * wInput + yLP * wLP + yBP * wBP + yHP * wHP;
+}
+
+template <typename SampleType, size_t NumChannels>
+template <size_t numStagesToProcess, bool blended, size_t frameWidth>
+void StateVariableTPTFilter<SampleType, NumChannels>::processSaturatingFrames(const SampleType* input, SampleType* output,
+                                                                              size_t numFrames, size_t firstChannel) noexcept
+{
+    constexpr auto cascaded = numStagesToProcess > 1;
+    const auto* mg = modulatedG;
+    const auto* mh = modulatedH;
+    const auto* mR2 = modulatedR2;
+    const auto* mMix = modulatedMix;
+    const auto* mDrive = modulatedDrive;
+    const auto* mInverseDrive = modulatedInverseDrive;
+    const auto* wInput = modulatedWeights;
+    const auto* wLP = wInput + interleavedBlockSize;
+    const auto* wBP = wLP + interleavedBlockSize;
+    const auto* wHP = wBP + interleavedBlockSize;
+    SampleType lR2Offset[numStagesToProcess], lR2Scale[numStagesToProcess];
+    SampleType ls1[numStagesToProcess][frameWidth], ls2[numStagesToProcess][frameWidth], ls3[numStagesToProcess][frameWidth];
+    SampleType lb1[numStagesToProcess][frameWidth], lb2[numStagesToProcess][frameWidth], lb3[numStagesToProcess][frameWidth];
+
+    // Blended, s1, s2 and s3 hold the cascade of the effective type and b1, b2
+    // and b3 the later stages of the other one, see processCascadeFrames().
+    const auto lowpassFirst = getEffectiveType() == Type::LP2;
+
+    for (size_t stage = 0; stage < numStagesToProcess; ++stage)
+    {
+        lR2Offset[stage] = stageR2Offset[stage];
+        lR2Scale[stage] = stageR2Scale[stage];
+
+        for (size_t lane = 0; lane < frameWidth; ++lane)
+        {
+            const auto index = stage * stateStride + firstChannel + lane;
+            ls1[stage][lane] = s1[index];
+            ls2[stage][lane] = s2[index];
+            ls3[stage][lane] = s3[index];
+
+            if (blended && stage > 0)
+            {
+                lb1[stage][lane] = b1[index];
+                lb2[stage][lane] = b2[index];
+                lb3[stage][lane] = b3[index];
+            }
+        }
+    }
+
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        const auto fg = mg[i], fDrive = mDrive[i], fInverseDrive = mInverseDrive[i];
+        const auto fInput = wInput[i], fLP = wLP[i], fBP = wBP[i], fHP = wHP[i];
+        SampleType x[frameWidth], y[frameWidth];
+
+        for (size_t lane = 0; lane < frameWidth; ++lane)
+            x[lane] = y[lane] = input[i * frameWidth + lane];
+
+        if (blended)
+        {
+            SampleType yLow[frameWidth], yHigh[frameWidth];
+
+            for (size_t lane = 0; lane < frameWidth; ++lane)
+            {
+                SampleType yLP, yBP, yHP;
+                processSaturatingCore(x[lane], ls1[0][lane], ls2[0][lane], ls3[0][lane],
+                                      fg, modulatedStageH[i], lR2Offset[0] + lR2Scale[0] * mR2[i],
+                                      fDrive, fInverseDrive, yLP, yBP, yHP);
+
+                yLow[lane] = yLP;
+                yHigh[lane] = yHP;
+            }
+
+            for (size_t stage = 1; stage < numStagesToProcess; ++stage)
+            {
+                const auto fh = modulatedStageH[stage * interleavedBlockSize + i];
+                const auto fR2 = lR2Offset[stage] + lR2Scale[stage] * mR2[i];
+
+                for (size_t lane = 0; lane < frameWidth; ++lane)
+                {
+                    SampleType yLP, yBP, yHP;
+                    processSaturatingCore(yLow[lane], lowpassFirst ? ls1[stage][lane] : lb1[stage][lane],
+                                          lowpassFirst ? ls2[stage][lane] : lb2[stage][lane],
+                                          lowpassFirst ? ls3[stage][lane] : lb3[stage][lane],
+                                          fg, fh, fR2, fDrive, fInverseDrive, yLP, yBP, yHP);
+                    yLow[lane] = yLP;
+
+                    processSaturatingCore(yHigh[lane], lowpassFirst ? lb1[stage][lane] : ls1[stage][lane],
+                                          lowpassFirst ? lb2[stage][lane] : ls2[stage][lane],
+                                          lowpassFirst ? lb3[stage][lane] : ls3[stage][lane],
+                                          fg, fh, fR2, fDrive, fInverseDrive, yLP, yBP, yHP);
+                    yHigh[lane] = yHP;
+                }
+            }
+
+            for (size_t lane = 0; lane < frameWidth; ++lane)
+                output[i * frameWidth + lane] = x[lane] + (yLow[lane] * fLP + yHigh[lane] * fHP - x[lane]) * mMix[i];
+
+            continue;
+        }
+
+        for (size_t stage = 0; stage < numStagesToProcess; ++stage)
+        {
+            const auto fh = cascaded ? modulatedStageH[stage * interleavedBlockSize + i] : mh[i];
+            const auto fR2 = cascaded ? lR2Offset[stage] + lR2Scale[stage] * mR2[i] : mR2[i];
+
+            for (size_t lane = 0; lane < frameWidth; ++lane)
+            {
+                SampleType yLP, yBP, yHP;
+                processSaturatingCore(y[lane], ls1[stage][lane], ls2[stage][lane], ls3[stage][lane],
+                                      fg, fh, fR2, fDrive, fInverseDrive, yLP, yBP, yHP);
+
+                y[lane] = y[lane] * fInput + yLP * fLP + yBP * fBP + yHP * fHP;
+            }
+        }
+
+        for (size_t lane = 0; lane < frameWidth; ++lane)
+            output[i * frameWidth + lane] = x[lane] + (y[lane] - x[lane]) * mMix[i];
+    }
+
+    for (size_t stage = 0; stage < numStagesToProcess; ++stage)
+    {
+        for (size_t lane = 0; lane < frameWidth; ++lane)
+        {
+            const auto index = stage * stateStride + firstChannel + lane;
+            s1[index] = ls1[stage][lane];
+            s2[index] = ls2[stage][lane];
+            s3[index] = ls3[stage][lane];
+
+            if (blended && stage > 0)
+            {
+                b1[index] = lb1[stage][lane];
+                b2[index] = lb2[stage][lane];
+                b3[index] = lb3[stage][lane];
+            }
+        }
+    }
+}
+
+template <typename SampleType, size_t NumChannels>
+SampleType StateVariableTPTFilter<SampleType, NumChannels>::processSaturatingSample(size_t channel, SampleType inputValue) noexcept
+{
+    const auto weights = getTargetWeights(morphProportion);
+    const auto cascaded = isCascaded();
+    const auto stagesToProcess = cascaded ? numStages : (size_t) 1;
+    const auto inverseDrive = static_cast<SampleType> (1) / drive;
+    auto y = inputValue;
+
+    if (cascaded && isMorphed())
+    {
+        const auto lowpassFirst = getEffectiveType() == Type::LP2;
+        auto* low1 = lowpassFirst ? s1 : b1;
+        auto* low2 = lowpassFirst ? s2 : b2;
+        auto* low3 = lowpassFirst ? s3 : b3;
+        auto* high1 = lowpassFirst ? b1 : s1;
+        auto* high2 = lowpassFirst ? b2 : s2;
+        auto* high3 = lowpassFirst ? b3 : s3;
+        SampleType yLow, yBP, yHigh;
+
+        processSaturatingCore(y, s1[channel], s2[channel], s3[channel], g, stageH[0], stageR2[0],
+                              drive, inverseDrive, yLow, yBP, yHigh);
+
+        for (size_t stage = 1; stage < stagesToProcess; ++stage)
+        {
+            const auto index = stage * stateStride + channel;
+            SampleType yLP, yHP;
+
+            processSaturatingCore(yLow, low1[index], low2[index], low3[index], g, stageH[stage], stageR2[stage],
+                                  drive, inverseDrive, yLP, yBP, yHP);
+            yLow = yLP;
+
+            processSaturatingCore(yHigh, high1[index], high2[index], high3[index], g, stageH[stage], stageR2[stage],
+                                  drive, inverseDrive, yLP, yBP, yHP);
+            yHigh = yHP;
+        }
+
+        return yLow * weights.get(1, stageR2[0]) + yHigh * weights.get(3, stageR2[0]);
+    }
+
+    for (size_t stage = 0; stage < stagesToProcess; ++stage)
+    {
+        const auto index = stage * stateStride + channel;
+        const auto damping = cascaded ? stageR2[stage] : R2;
+        SampleType yLP, yBP, yHP;
+
+        processSaturatingCore(y, s1[index], s2[index], s3[index], g, cascaded ? stageH[stage] : h, damping,
+                              drive, inverseDrive, yLP, yBP, yHP);
+
+        y = y * weights.get(0, damping) + yLP * weights.get(1, damping) + yBP * weights.get(2, damping) + yHP * weights.get(3, damping);
+    }
+
+    return y;
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::processSaturatingCore(SampleType inputValue, SampleType& ls1, SampleType& ls2, SampleType& ls3,
+                                                                            SampleType g, SampleType h, SampleType R2,
+                                                                            SampleType drive, SampleType inverseDrive,
+                                                                            SampleType& yLP, SampleType& yBP, SampleType& yHP) noexcept
+{
+    // The band pass is yBP = f(yHP) * g + ls1, where f(v) is the saturator scaled
+    // by the drive, averaged over the step from its last input, and
+    // yHP = x - ls2 - yBP * (g + R2). Solving the loop with the averaged
+    // saturator keeps the antialiasing consistent with the state. Newton's
+    // method starts from the linear solution, which is also where it stays
+    // below the knee, and its slope is never below 1.
+    const auto one = static_cast<SampleType> (1);
+    const auto c = g + R2;
+    const auto xs = inputValue - ls2;
+    const auto lastIntegral = getSaturationResidualIntegral(ls3);
+    auto bp = (xs * g + ls1) * h;
+    SampleType slope;
+
+    for (int iteration = 0; iteration < numSaturationIterations; ++iteration)
+    {
+        const auto v = xs - bp * c;
+        const auto f = v + getAveragedSaturationResidual(v * drive, ls3, lastIntegral, slope) * inverseDrive;
+
+        bp -= (bp - ls1 - f * g) / (one + g * c * (one + slope));
+    }
+
+    const auto v = xs - bp * c;
+    const auto u = v * drive;
+    const auto w = v + getAveragedSaturationResidual(u, ls3, lastIntegral, slope) * inverseDrive;
+    ls3 = u;
+
+    yHP = v;
+    yBP = w * g + ls1;
+    ls1 = w * g + yBP;
+
+    yLP = yBP * g + ls2;
+    ls2 = yBP * g + yLP;
+}
+
 //==============================================================================
-template <typename SampleType>
-void StateVariableTPTFilter<SampleType>::update()
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::update()
+{
+    calculateCoefficients(cutoffFrequency, resonance, g, h, R2);
+
+    for (size_t stage = 0; stage < numStages; ++stage)
+    {
+        stageR2[stage] = getStageR2(stage, R2);
+        stageH[stage] = static_cast<SampleType> (1.0 / (1.0 + stageR2[stage] * g + g * g));
+    }
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::updateStages()
+{
+    // Butterworth of order 2N puts its pole pairs at angles (2k - 1) * pi / 4N, and
+    // Linkwitz-Riley of order 2N doubles up the poles of Butterworth of order N.
+    // Sorted by Q, so that the last stage is the most resonant one.
+    const auto linkwitzRiley = alignment == Alignment::linkwitzRiley && numStages % 2 == 0;
+    const auto pi = juce::MathConstants<double>::pi;
+
+    for (size_t stage = 0; stage < numStages; ++stage)
+    {
+        const auto angle = linkwitzRiley ? static_cast<double> (2 * (stage / 2) + 1) * pi / static_cast<double> (2 * numStages)
+                                         : static_cast<double> (2 * stage + 1) * pi / static_cast<double> (4 * numStages);
+        const auto q = 0.5 / std::cos(angle);
+        const auto isLast = stage == numStages - 1;
+
+        stageR2Offset[stage] = static_cast<SampleType> (isLast ? 0.0 : 1.0 / q);
+        stageR2Scale[stage] = static_cast<SampleType> (isLast ? 1.0 / (q * juce::MathConstants<double>::sqrt2) : 0.0);
+    }
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::calculateCoefficients(double cutoff, double res,
+                                                                            SampleType& newG, SampleType& newH, SampleType& newR2) const noexcept
+{
+    const auto wc = piOverSampleRate * cutoff;
+
+    newG = static_cast<SampleType> (coefficientMode == CoefficientMode::fast ? juce::dsp::FastMathApproximations::tan(wc)
+                                                                             : std::tan(wc));
+    newR2 = static_cast<SampleType> (1.0 / res);
+    newH = static_cast<SampleType> (1.0 / (1.0 + newR2 * newG + newG * newG));
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::updateModulation(const SampleType* cutoffFrequencies, size_t numFrames) noexcept
+{
+    jassert(numFrames <= interleavedBlockSize);
+
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        const auto cutoff = cutoffFrequencies != nullptr ? cutoffFrequencies[i] : cutoffSmoother.getNextValue();
+        jassert(juce::isPositiveAndBelow(cutoff, static_cast<SampleType> (sampleRate * 0.5)));
+
+        calculateCoefficients(cutoff, resonanceSmoother.getNextValue(), modulatedG[i], modulatedH[i], modulatedR2[i]);
+    }
+
+    if (! isCascaded())
+        return;
+
+    for (size_t stage = 0; stage < numStages; ++stage)
+    {
+        auto* stageHs = modulatedStageH + stage * interleavedBlockSize;
+
+        for (size_t i = 0; i < numFrames; ++i)
+        {
+            const auto fg = modulatedG[i];
+            stageHs[i] = static_cast<SampleType> (1.0 / (1.0 + getStageR2(stage, modulatedR2[i]) * fg + fg * fg));
+        }
+    }
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::updateMix(size_t numFrames) noexcept
+{
+    jassert(numFrames <= interleavedBlockSize);
+
+    if (! mixSmoother.isSmoothing())
+    {
+        std::fill(modulatedMix, modulatedMix + numFrames, wetMixProportion);
+        return;
+    }
+
+    for (size_t i = 0; i < numFrames; ++i)
+        modulatedMix[i] = mixSmoother.getNextValue();
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::updateWeights(size_t numFrames, bool modulated) noexcept
+{
+    jassert(numFrames <= interleavedBlockSize);
+
+    // Types that can't be blended leave the morph type's weights at those of
+    // the type, so that the morph proportion has no effect.
+    const auto blend = canMorph();
+    const auto typeWeights = blend ? getOutputWeights(filterType) : getTargetWeights(morphProportion);
+    const auto morphWeights = blend ? getOutputWeights(morphType) : typeWeights;
+    const auto fromWeights = typeFadeWeights;
+    const auto fading = typeFadeSmoother.isSmoothing();
+    const auto lR2 = R2;
+    const auto* mR2 = modulatedR2;
+
+    // Local copies, as with the coefficients in the kernels, so that writing the
+    // weights can't force the compiler to reload the ramps.
+    auto morph = morphSmoother;
+    auto fade = typeFadeSmoother;
+
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        const auto proportion = morph.getNextValue();
+        const auto fadeProportion = fading ? fade.getNextValue() : static_cast<SampleType> (1);
+        const auto damping = modulated ? mR2[i] : lR2;
+
+        for (size_t output = 0; output < typeWeights.offset.size(); ++output)
+        {
+            const auto first = typeWeights.get(output, damping);
+            const auto target = first + (morphWeights.get(output, damping) - first) * proportion;
+            const auto from = fromWeights.get(output, damping);
+
+            modulatedWeights[output * interleavedBlockSize + i] = fading ? from + (target - from) * fadeProportion : target;
+        }
+    }
+
+    morphSmoother = morph;
+    typeFadeSmoother = fade;
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::fillModulation(size_t numFrames) noexcept
+{
+    jassert(numFrames <= interleavedBlockSize);
+
+    const auto frames = (std::ptrdiff_t) numFrames;
+    std::fill(modulatedG, modulatedG + frames, g);
+    std::fill(modulatedH, modulatedH + frames, h);
+    std::fill(modulatedR2, modulatedR2 + frames, R2);
+
+    if (! isCascaded())
+        return;
+
+    for (size_t stage = 0; stage < numStages; ++stage)
+    {
+        auto* stageHs = modulatedStageH + stage * interleavedBlockSize;
+        std::fill(stageHs, stageHs + frames, stageH[stage]);
+    }
+}
+
+template <typename SampleType, size_t NumChannels>
+void StateVariableTPTFilter<SampleType, NumChannels>::updateDrive(size_t numFrames) noexcept
 {
-    g = static_cast<SampleType> (std::tan(juce::MathConstants<double>::pi * cutoffFrequency / sampleRate));
-    R2 = static_cast<SampleType> (1.0 / resonance);
-    h = static_cast<SampleType> (1.0 / (1.0 + R2 * g + g * g));
+    jassert(numFrames <= interleavedBlockSize);
+
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        const auto newDrive = driveSmoother.isSmoothing() ? driveSmoother.getNextValue() : drive;
+
+        // At a drive of 0 the residual is 0 too, and the filter is linear.
+        modulatedDrive[i] = newDrive;
+        modulatedInverseDrive[i] = newDrive > static_cast<SampleType> (0) ? static_cast<SampleType> (1) / newDrive
+                                                                          : static_cast<SampleType> (0);
+    }
 }
 
 //==============================================================================
 template class StateVariableTPTFilter<float>;
-template class StateVariableTPTFilter<double>;
\ No newline at end of file
+template class StateVariableTPTFilter<double>;
+template class StateVariableTPTFilter<float, 1>;
+template class StateVariableTPTFilter<double, 1>;
+template class StateVariableTPTFilter<float, 2>;
+template class StateVariableTPTFilter<double, 2>;
\ No newline at end of file
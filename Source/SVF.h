@@ -8,6 +8,8 @@
   ==============================================================================
 */
 
+#pragma once
+
 #include <JuceHeader.h>
 
 /*enum class StateVariableTPTFilterType
@@ -40,6 +42,90 @@ enum class StateVariableTPTFilterType
     P2
 };
 
+/** How StateVariableTPTFilter computes its coefficients.
+
+    exact uses std::tan. fast uses juce::dsp::FastMathApproximations::tan, a
+    [7/6] Pade approximant evaluated in double precision: its relative error
+    in g stays below 4e-10 up to 0.4 * fs, below 6.4e-8 (float epsilon) up to
+    0.49 * fs and below 1e-6 up to 0.499 * fs, so the response is as accurate
+    as the float signal path right up to Nyquist.
+*/
+enum class StateVariableTPTFilterCoefficientMode
+{
+    exact,
+    fast
+};
+
+/** How the resonance of each stage is chosen when StateVariableTPTFilter
+    cascades several stages for a steeper slope.
+
+    butterworth gives the maximally flat response of the full order, and
+    linkwitzRiley the square of a Butterworth filter of half the order, which is
+    6 dB down at the cutoff so that lowpass and highpass outputs sum flat. A
+    Linkwitz-Riley alignment needs an even number of stages; an odd number falls
+    back to Butterworth.
+*/
+enum class StateVariableTPTFilterAlignment
+{
+    butterworth,
+    linkwitzRiley
+};
+
+//==============================================================================
+/** The coefficients that set the response of a StateVariableTPTFilter, see
+    StateVariableTPTFilter::getResponse(), from which the frequency response is
+    worked out analytically, without running any signal.
+
+    The TPT structure is the bilinear transform of the analog state variable
+    filter, so at a frequency f each stage is N(s) / (s^2 + R2 s + 1), with
+    s = j tan(pi f / fs) / g and a numerator N that depends on the type. The
+    stages multiply, the morph proportion blends the results for the two types,
+    and the wet mix proportion blends that with 1.
+
+    It is a plain value, cheap to copy and compare, so it can be handed to
+    another thread, or compared with the last one to know whether a cached
+    curve is still valid.
+*/
+struct StateVariableTPTFilterResponse
+{
+    static constexpr size_t maxNumStages = 4;
+
+    StateVariableTPTFilterType type = StateVariableTPTFilterType::LP2;
+
+    /** The type the response is morphed towards, and how far, see
+        StateVariableTPTFilter::setMorphProportion(). The response moves in a
+        straight line from that of type to that of morphType, which for a
+        single stage is the same as moving its numerator.
+    */
+    StateVariableTPTFilterType morphType = StateVariableTPTFilterType::LP2;
+    double morphProportion = 0.0;
+
+    double sampleRate = 44100.0;
+    double g = 0.0;
+    double wetMixProportion = 1.0;
+
+    /** The damping, 1 / Q, of each stage in use. */
+    std::array<double, maxNumStages> stageR2 {};
+    size_t numStages = 1;
+
+    /** Evaluates the response at numFrequencies frequencies, in Hz, at once.
+        Either output may be nullptr. Magnitudes are linear gains and phases
+        are in radians, between -pi and pi. Frequencies are clamped to the range
+        from 0 to just below Nyquist.
+    */
+    void getMagnitudeAndPhase(const double* frequencies, double* magnitudes, double* phases,
+                              size_t numFrequencies) const noexcept;
+
+    /** Returns the linear gain at one frequency, in Hz. */
+    double getMagnitudeForFrequency(double frequency) const noexcept;
+
+    /** Returns the phase in radians at one frequency, in Hz. */
+    double getPhaseForFrequency(double frequency) const noexcept;
+
+    bool operator== (const StateVariableTPTFilterResponse& other) const noexcept;
+    bool operator!= (const StateVariableTPTFilterResponse& other) const noexcept   { return ! operator== (other); }
+};
+
 //==============================================================================
 /** An IIR filter that can perform low, band and high-pass filtering on an audio
     signal, with 12 dB of attenuation per octave, using a TPT structure, designed
@@ -54,27 +140,84 @@ enum class StateVariableTPTFilterType
     Note 2: Using this class prevents some loud audio artefacts commonly encountered when
     changing the cutoff frequency using other filter simulation structures and IIR
     filter classes. However, this class may still require additional smoothing for
-    cutoff frequency changes.
+    cutoff frequency changes: see setRampDurationSeconds(), or pass a cutoff
+    frequency for every sample to process().
+
+    Note 3: NumChannels fixes the channel count at compile time. The state then
+    lives inline in the object, and the channel loop is resolved by the
+    compiler. The default of 0 takes the channel count from prepare() and keeps
+    the state on the heap. Either way, the scratch space the block engine works
+    in is allocated once, by the first prepare(), and never inline, so a filter
+    that is never prepared costs only its state and settings.
+
+    Note 4: The LP2 and HP2 types can cascade up to four stages for slopes of 24,
+    36 or 48 dB / octave, see setNumStages(). All stages run in the same pass over
+    the samples and keep their state in the filter, so a steep slope costs one
+    filter instead of a chain of them.
+
+    Note 5: Every type's output is a weighted sum of the input and the lowpass,
+    bandpass and highpass outputs of the same core, so changing the type, or
+    morphing between two (see setMorphProportion()), only moves the weights. The
+    kernel blends them per sample while they move, with no second filter, and
+    goes back to the plain kernel of a single type once they settle. Cascades
+    of LP2 and HP2 share their first stage, and while the two are blended the
+    later stages of the other one run alongside, so that it's the outputs of
+    the two cascades that are blended rather than every stage, which would
+    take 6 dB out of the passband per stage halfway through.
+
+    Note 6: With a drive above 0 (see setDrive()) the first integrator takes its
+    input through a saturator, inside the loop, which bounds the resonance the
+    way an analog filter's does. Each sample is solved with a fixed number of
+    Newton iterations, so the cost doesn't depend on the signal, and the
+    saturation is antialiased with its antiderivative (ADAA), so it needs little
+    or no oversampling. Small signals get the linear response whatever the
+    drive.
 
     see IIRFilter, SmoothedValue
 
     @tags{DSP}
 */
-template <typename SampleType>
+template <typename SampleType, size_t NumChannels = 0>
 class StateVariableTPTFilter
 {
 public:
     //==============================================================================
     using Type = StateVariableTPTFilterType;
+    using CoefficientMode = StateVariableTPTFilterCoefficientMode;
+    using Alignment = StateVariableTPTFilterAlignment;
+
+    /** The largest number of cascaded stages, for a 48 dB / octave slope. */
+    static constexpr size_t maxNumStages = 4;
 
     //==============================================================================
     /** Constructor. */
     StateVariableTPTFilter();
 
     //==============================================================================
-    /** Sets the filter type. */
+    /** Sets the filter type. The output crossfades from the old type to the new
+        one over getRampDurationSeconds(), or switches at once with no ramp or
+        when the number of stages in use changes with it.
+    */
     void setType(Type newType);
 
+    /** Sets a second type for the output to morph towards, see
+        setMorphProportion(). Changes are crossfaded as for setType().
+    */
+    void setMorphType(Type newType);
+
+    /** Sets how far the output has morphed from the type towards the morph type,
+        from 0 (the default, the type alone) to 1 (the morph type alone). In
+        between, the weights each type gives the core's outputs are blended, so
+        the response moves smoothly from one to the other. Changes are ramped
+        over getRampDurationSeconds().
+
+        With more than one stage a cascading type (LP2, HP2) can only morph into
+        the other one, which blends the outputs of the two cascades and costs
+        up to twice as much while it's held; between a cascading type and any
+        other the output switches to the morph type halfway instead.
+    */
+    void setMorphProportion(SampleType newProportion);
+
     /** Sets the cutoff frequency of the filter.
 
         @param newFrequencyHz the new cutoff frequency in Hz.
@@ -89,16 +232,109 @@ public:
     */
     void setResonance(SampleType newResonance);
 
+    /** Sets how the coefficients are computed when the cutoff frequency or
+        resonance changes. The fast mode avoids calling std::tan, which makes
+        audio rate modulation of the cutoff affordable.
+    */
+    void setCoefficientMode(CoefficientMode newMode);
+
+    /** Sets the length of the ramp used to smooth cutoff frequency and resonance
+        changes. While a ramp is running the coefficients are recomputed for every
+        sample. A duration of zero (the default) applies changes immediately.
+
+        Note: processSample() does not advance the ramp and always uses the target
+        values.
+    */
+    void setRampDurationSeconds(double newDurationSeconds);
+
+    /** Sets the proportion of filtered signal in the output, between 0 (dry) and
+        1 (fully wet, the default). The dry signal is mixed in by the filter
+        kernel itself, as dry * (1 - proportion) + wet * proportion, in the same
+        pass over the samples. Changes are ramped over getRampDurationSeconds().
+    */
+    void setWetMixProportion(SampleType newWetMixProportion);
+
+    /** Sets the gain into the saturator of each stage, from 0 (the default), which
+        keeps the filter linear and on its plain kernels, upwards. The loop
+        saturates from 0.5 / drive and holds at 1 / drive, so at a drive of 1 it
+        starts to bend at half of full scale. Changes are ramped over
+        getRampDurationSeconds().
+
+        processMultiOutput() always stays linear.
+    */
+    void setDrive(SampleType newDrive);
+
+    /** Sets the number of cascaded 12 dB / octave stages, from 1 (the default) to
+        maxNumStages, used by the LP2 and HP2 types. The other types always run a
+        single stage.
+
+        The stages share the cutoff frequency and have their resonances set by the
+        alignment. The resonance parameter drives the last, most resonant stage,
+        and gives the plain alignment at 1 / sqrt(2). Stages that become active
+        start from silence.
+    */
+    void setNumStages(size_t newNumStages);
+
+    /** Sets how the resonances of the cascaded stages are distributed. */
+    void setAlignment(Alignment newAlignment);
+
     //==============================================================================
     /** Returns the type of the filter. */
     Type getType() const noexcept { return filterType; }
 
+    /** Returns the type the filter morphs towards. */
+    Type getMorphType() const noexcept { return morphType; }
+
+    /** Returns how far the filter has morphed towards the morph type. */
+    SampleType getMorphProportion() const noexcept { return morphProportion; }
+
     /** Returns the cutoff frequency of the filter. */
     SampleType getCutoffFrequency() const noexcept { return cutoffFrequency; }
 
     /** Returns the resonance of the filter. */
     SampleType getResonance() const noexcept { return resonance; }
 
+    /** Returns how the coefficients of the filter are computed. */
+    CoefficientMode getCoefficientMode() const noexcept { return coefficientMode; }
+
+    /** Returns the proportion of filtered signal in the output. */
+    SampleType getWetMixProportion() const noexcept { return wetMixProportion; }
+
+    /** Returns the gain into the saturators, or 0 if the filter is linear. */
+    SampleType getDrive() const noexcept { return drive; }
+
+    /** Returns the number of cascaded stages. */
+    size_t getNumStages() const noexcept { return numStages; }
+
+    /** Returns how the resonances of the cascaded stages are distributed. */
+    Alignment getAlignment() const noexcept { return alignment; }
+
+    /** Returns the length of the cutoff frequency, resonance, mix, type and drive ramps. */
+    double getRampDurationSeconds() const noexcept { return rampDurationSeconds; }
+
+    /** Returns true if the cutoff frequency or resonance is still ramping. */
+    bool isSmoothing() const noexcept { return cutoffSmoother.isSmoothing() || resonanceSmoother.isSmoothing(); }
+
+    /** Returns how long the filter keeps ringing once its input stops, until its
+        output has decayed by decayDecibels, for the current cutoff frequency,
+        resonance, stages and drive. The time is that of the slowest pole of each
+        stage, added up over the cascade. With a drive, each stage first takes
+        the time to slew down from full scale to the saturation knee.
+    */
+    double getTailLengthSeconds(double decayDecibels = 120.0) const noexcept;
+
+    /** Returns the coefficients that set the response of the filter, for its
+        current settings, from which the magnitude and phase at any frequency can
+        be worked out without running any signal. While a ramp is running this is
+        the response it is heading for.
+    */
+    StateVariableTPTFilterResponse getResponse() const noexcept;
+
+    /** Returns the largest magnitude of the state variables in use. Once this is
+        negligible the filter has rung out, and silent input gives silent output.
+    */
+    SampleType getStateMagnitude() const noexcept;
+
     //==============================================================================
     /** Initialises the filter. */
     void prepare(const juce::dsp::ProcessSpec& spec);
@@ -116,18 +352,36 @@ public:
     void snapToZero() noexcept;
 
     //==============================================================================
-    /** Processes the input and output samples supplied in the processing context. */
+    /** Processes the input and output samples supplied in the processing context.
+
+        Channels are interleaved into SIMDRegister lanes, so a stereo or quad bus
+        advances with a single vector operation per sample (two on an 8 channel
+        bus). Where SIMD is unavailable each channel runs on the scalar path.
+    */
     template <typename ProcessContext>
     void process(const ProcessContext& context) noexcept
+    {
+        process(context, nullptr);
+    }
+
+    /** Processes the samples supplied in the processing context, modulating the
+        cutoff frequency at audio rate.
+
+        @param cutoffFrequencies one cutoff frequency in Hz for every sample in the
+                                 context, shared by all channels, or nullptr to
+                                 use the (smoothed) cutoff frequency. The last
+                                 value becomes the new cutoff frequency.
+    */
+    template <typename ProcessContext>
+    void process(const ProcessContext& context, const SampleType* cutoffFrequencies) noexcept
     {
         const auto& inputBlock = context.getInputBlock();
         auto& outputBlock = context.getOutputBlock();
-        const auto numChannels = outputBlock.getNumChannels();
-        const auto numSamples = outputBlock.getNumSamples();
 
-        jassert(inputBlock.getNumChannels() <= s1.size());
-        jassert(inputBlock.getNumChannels() == numChannels);
-        jassert(inputBlock.getNumSamples() == numSamples);
+        jassert(inputBlock.getNumChannels() <= numStateChannels);
+        jassert(! hasFixedChannels || inputBlock.getNumChannels() == NumChannels);
+        jassert(inputBlock.getNumChannels() == outputBlock.getNumChannels());
+        jassert(inputBlock.getNumSamples() == outputBlock.getNumSamples());
 
         if (context.isBypassed)
         {
@@ -135,33 +389,426 @@ public:
             return;
         }
 
-        for (size_t channel = 0; channel < numChannels; ++channel)
-        {
-            auto* inputSamples = inputBlock.getChannelPointer(channel);
-            auto* outputSamples = outputBlock.getChannelPointer(channel);
-
-            for (size_t i = 0; i < numSamples; ++i)
-                outputSamples[i] = processSample((int)channel, inputSamples[i]);
-        }
+        processBlock(inputBlock, outputBlock, cutoffFrequencies);
 
 #if JUCE_DSP_ENABLE_SNAP_TO_ZERO
         snapToZero();
 #endif
     }
 
+    /** Processes the input block once and writes the lowpass, bandpass and
+        highpass outputs to separate blocks, whatever the filter type is.
+
+        Pass an empty block for any output that isn't needed. The bandpass output
+        is the normalised one (BP2n), so the three outputs sum back to the input,
+        which makes them a ready-made 3-band split. The wet mix proportion does
+        not apply here.
+    */
+    void processMultiOutput(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                            const juce::dsp::AudioBlock<SampleType>& lowpassBlock,
+                            const juce::dsp::AudioBlock<SampleType>& bandpassBlock,
+                            const juce::dsp::AudioBlock<SampleType>& highpassBlock) noexcept;
+
     //==============================================================================
     /** Processes one sample at a time on a given channel. */
     SampleType processSample(int channel, SampleType inputValue);
 
 private:
     //==============================================================================
+   #if JUCE_USE_SIMD
+    using SIMDType = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr size_t numLanes = SIMDType::SIMDNumElements;
+   #else
+    using SIMDType = SampleType;
+    static constexpr size_t numLanes = 1;
+   #endif
+
+    static constexpr bool hasFixedChannels = NumChannels > 0;
+    static constexpr size_t numFixedPaddedChannels = ((NumChannels + numLanes - 1) / numLanes) * numLanes;
+
+    /** Number of frames interleaved into SIMD lanes, or modulated, at a time.
+        Small enough that the scratch buffers stay in L1 cache whatever the host
+        block size is, and smaller still for the fixed channel variants so that
+        they stay compact.
+    */
+    static constexpr size_t interleavedBlockSize = hasFixedChannels ? 64 : 256;
+
+    /** Two SIMD registers side by side, which the kernels treat as one wider
+        vector. A group's recurrence is a chain of dependent multiply-adds, so on
+        wide buses a second, independent group runs in the gaps of the first.
+    */
+    struct SIMDPair
+    {
+        SIMDType a, b;
+
+        SIMDPair operator+ (const SIMDPair& other) const noexcept { return { a + other.a, b + other.b }; }
+        SIMDPair operator- (const SIMDPair& other) const noexcept { return { a - other.a, b - other.b }; }
+        SIMDPair operator* (SampleType scalar) const noexcept     { return { a * scalar, b * scalar }; }
+    };
+
+    /** True if a bus can have enough channels to fill a SIMDPair. */
+    static constexpr bool canPairGroups = numLanes > 1 && (! hasFixedChannels || NumChannels >= 2 * numLanes);
+
+    //==============================================================================
     void update();
+    void updateStages();
+    void calculateCoefficients(double cutoff, double res, SampleType& newG, SampleType& newH, SampleType& newR2) const noexcept;
+    void allocate(size_t numChannels);
+    void allocateScratch();
+
+    /** The weights of a type's output, in the order input, lowpass, bandpass and
+        highpass. Each is offset + scale * R2, as some follow the damping, which
+        also means that the weights of two types blend linearly.
+    */
+    struct OutputWeights
+    {
+        std::array<SampleType, 4> offset {}, scale {};
+
+        SampleType get(size_t output, SampleType damping) const noexcept { return offset[output] + scale[output] * damping; }
+
+        bool operator== (const OutputWeights& other) const noexcept { return offset == other.offset && scale == other.scale; }
+    };
+
+    static OutputWeights getOutputWeights(Type type) noexcept;
+    static OutputWeights interpolate(const OutputWeights& from, const OutputWeights& to, SampleType proportion) noexcept;
+
+    static bool isCascadingType(Type type) noexcept { return type == Type::LP2 || type == Type::HP2; }
+
+    /** True if the type and the morph type run the same stages, so that their
+        weights can be blended.
+    */
+    bool canMorph() const noexcept
+    {
+        return numStages == 1 || isCascadingType(filterType) == isCascadingType(morphType);
+    }
+
+    /** True while the output is held part way between the type and the morph type. */
+    bool isMorphed() const noexcept
+    {
+        return canMorph() && morphType != filterType
+               && morphProportion > static_cast<SampleType> (0) && morphProportion < static_cast<SampleType> (1);
+    }
+
+    /** True while the output weights aren't those of a single type, either held
+        between two or ramping.
+    */
+    bool isWeighted() const noexcept
+    {
+        return typeFadeSmoother.isSmoothing() || isMorphed()
+               || (canMorph() && morphType != filterType && morphSmoother.isSmoothing());
+    }
+
+    /** The type that picks the stages and, unless the output is weighted, the
+        kernel: the morph type once fully morphed, or past halfway when the two
+        can't be blended.
+    */
+    Type getEffectiveType() const noexcept
+    {
+        const auto threshold = static_cast<SampleType> (canMorph() ? 1.0 : 0.5);
+        return morphProportion >= threshold ? morphType : filterType;
+    }
+
+    /** The weights the output settles on, for a given morph proportion. */
+    OutputWeights getTargetWeights(SampleType proportion) const noexcept;
+
+    /** The weights the output has at the moment, part way through any ramp. */
+    OutputWeights getCurrentWeights() const noexcept;
+
+    /** Crossfades the output from the given weights, as they were before the type
+        or morph type changed, to the new target weights.
+    */
+    void startTypeFade(const OutputWeights& fromWeights, bool wasCascaded);
+
+    /** Clears the state of the stages the effective type doesn't use, so that
+        they start from silence when it cascades again.
+    */
+    void clearUnusedStages() noexcept;
+
+    /** Keeps the cascade of the effective type in s1, s2 and s3, and that of the
+        other cascading type in b1, b2 and b3, by swapping their later stages
+        when the effective type changes between LP2 and HP2.
+    */
+    void updateCascades() noexcept;
+
+    /** Called before output that blends the two cascades: the other cascade
+        starts from silence, unless it has been running all along.
+    */
+    void prepareOtherCascade() noexcept;
+
+    /** True while the output blends the cascades of LP2 and HP2. */
+    bool isBlendingCascades(bool weighted) const noexcept { return weighted && isCascaded(); }
+
+    /** True when the effective type runs more than one stage. */
+    bool isCascaded() const noexcept
+    {
+        return numStages > 1 && isCascadingType(getEffectiveType());
+    }
+
+    /** Returns the damping of a cascaded stage, given the damping 1 / resonance. */
+    SampleType getStageR2(size_t stage, SampleType newR2) const noexcept
+    {
+        return stageR2Offset[stage] + stageR2Scale[stage] * newR2;
+    }
+
+    /** Fills the per-sample coefficients for the next numFrames samples, either
+        from the given cutoff frequencies or from the ramps.
+    */
+    void updateModulation(const SampleType* cutoffFrequencies, size_t numFrames) noexcept;
+
+    /** Fills the per-sample wet mix proportions for the next numFrames samples. */
+    void updateMix(size_t numFrames) noexcept;
+
+    /** Fills the per-sample output weights for the next numFrames samples, from
+        the type and morph ramps. Modulated sub-blocks call it after
+        updateModulation(), as the weights follow the per-sample damping.
+    */
+    void updateWeights(size_t numFrames, bool modulated) noexcept;
+
+    /** processSample() for output weights held between two types. */
+    SampleType processWeightedSample(size_t channel, SampleType inputValue) noexcept;
+
+    /** True while the saturators are in the loop, or ramping out of it. */
+    bool isSaturating() const noexcept { return drive > static_cast<SampleType> (0) || driveSmoother.isSmoothing(); }
+
+    /** Fills the per-sample coefficients for the next numFrames samples with the
+        fixed ones, for the saturating kernel, which always reads them.
+    */
+    void fillModulation(size_t numFrames) noexcept;
+
+    /** Fills the per-sample drives, and their reciprocals, for the next
+        numFrames samples.
+    */
+    void updateDrive(size_t numFrames) noexcept;
+
+    /** processSample() with the saturators in the loop. */
+    SampleType processSaturatingSample(size_t channel, SampleType inputValue) noexcept;
+
+    /** The block engine with the saturators in the loop, for one sub-block. It
+        reads every coefficient, mix proportion, output weight and drive from the
+        per-sample arrays, whatever is ramping. blended is true while the output
+        blends the cascades of LP2 and HP2.
+    */
+    void processSaturatingBlock(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                                const juce::dsp::AudioBlock<SampleType>& outputBlock,
+                                bool blended) noexcept;
+
+    template <size_t numStagesToProcess, bool blended>
+    void processSaturatingStages(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                                 const juce::dsp::AudioBlock<SampleType>& outputBlock) noexcept;
+
+    /** Runs frames of frameWidth channels through the saturating stages, the state
+        of the first one at firstChannel. SIMDRegister has no division for the
+        Newton steps and the ADAA, so the channels of a frame are the inner loop,
+        the same arithmetic on independent lanes that compilers vectorise.
+    */
+    template <size_t numStagesToProcess, bool blended, size_t frameWidth>
+    void processSaturatingFrames(const SampleType* input, SampleType* output, size_t numFrames,
+                                 size_t firstChannel) noexcept;
+
+    /** The TPT core with a saturator at the input of the first integrator, for one
+        sample of one channel. ls3 holds the saturator's last input, for the ADAA.
+    */
+    static forcedinline void processSaturatingCore(SampleType inputValue, SampleType& ls1, SampleType& ls2, SampleType& ls3,
+                                                   SampleType g, SampleType h, SampleType R2,
+                                                   SampleType drive, SampleType inverseDrive,
+                                                   SampleType& yLP, SampleType& yBP, SampleType& yHP) noexcept;
+
+    /** Newton iterations per sample and stage. The loop equation is monotonic, and
+        two steps from the linear solution leave an error well below the ADAA's.
+    */
+    static constexpr int numSaturationIterations = 2;
+
+    /** Runs the filter over every channel of a block, packing up to numLanes
+        channels into each SIMD register so that they all advance together.
+        Modulated, mixed or weighted blocks are split into sub-blocks with
+        per-sample coefficients, mix proportions and output weights.
+    */
+    void processBlock(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                      const juce::dsp::AudioBlock<SampleType>& outputBlock,
+                      const SampleType* cutoffFrequencies) noexcept;
+
+    template <bool modulated, bool mixed>
+    void processBlockForType(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                             const juce::dsp::AudioBlock<SampleType>& outputBlock,
+                             bool weighted) noexcept;
+
+    /** The block engine for one filter type. The type is resolved once per block
+        by processBlockForType(), so the per-sample loop carries no branch and only
+        the arithmetic its own output needs. A modulated block reads its
+        coefficients from the per-sample arrays, a mixed block its mix
+        proportions, and a weighted block ignores the type and mixes the core's
+        outputs with the per-sample output weights; any of these must fit in one
+        sub-block.
+    */
+    template <Type type, size_t numStagesToProcess, bool modulated, bool mixed, bool weighted>
+    void processBlock(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                      const juce::dsp::AudioBlock<SampleType>& outputBlock) noexcept;
+
+    /** Runs one group of channels, interleaved into VecType frames, through a
+        block. The group is as wide as VecType, less any padding lanes.
+    */
+    template <Type type, size_t numStagesToProcess, bool modulated, bool mixed, bool weighted, typename VecType>
+    void processInterleaved(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                            const juce::dsp::AudioBlock<SampleType>& outputBlock,
+                            size_t firstChannel, size_t numGroupChannels) noexcept;
+
+    template <Type type, bool modulated, bool mixed, bool weighted>
+    void processBlockForStages(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                               const juce::dsp::AudioBlock<SampleType>& outputBlock) noexcept;
+
+    template <Type type, bool modulated, bool mixed, bool weighted, typename VecType>
+    void processFrames(const VecType* input, VecType* output, size_t numFrames,
+                       VecType& state1, VecType& state2) const noexcept;
+
+    /** Runs every stage of a cascade on each frame before moving to the next one,
+        so that the intermediate signals never leave the registers. The state of
+        stage k starts at stateStride * k from state1 and state2. Weighted, the
+        later stages of the other cascading type's cascade run alongside, from
+        otherState1 and otherState2, and the output blends the two cascades.
+    */
+    template <Type type, size_t numStagesToProcess, bool modulated, bool mixed, bool weighted, typename VecType>
+    void processCascadeFrames(const VecType* input, VecType* output, size_t numFrames,
+                              SampleType* state1, SampleType* state2,
+                              SampleType* otherState1, SampleType* otherState2) const noexcept;
+
+    template <Type type>
+    SampleType processCascadeSample(size_t channel, SampleType inputValue) noexcept;
+
+    template <Type type, typename VecType>
+    static VecType processFrame(VecType inputValue, VecType& ls1, VecType& ls2,
+                                SampleType g, SampleType h, SampleType R2) noexcept;
+
+    /** processFrame() with the output weights given, rather than set by a type. */
+    template <typename VecType>
+    static VecType processWeightedFrame(VecType inputValue, VecType& ls1, VecType& ls2,
+                                        SampleType g, SampleType h, SampleType R2,
+                                        SampleType wInput, SampleType wLP, SampleType wBP, SampleType wHP) noexcept;
+
+    /** The shared TPT core: advances the state and returns all three outputs. */
+    template <typename VecType>
+    static void processCore(VecType inputValue, VecType& ls1, VecType& ls2,
+                            SampleType g, SampleType h, SampleType R2,
+                            VecType& yLP, VecType& yBP, VecType& yHP) noexcept;
+
+    /** Copies channels into, or out of, frames of frameWidth samples each. */
+    template <size_t frameWidth>
+    static void interleave(const juce::dsp::AudioBlock<const SampleType>& block,
+                           size_t firstChannel, size_t numGroupChannels,
+                           size_t start, size_t numFrames, SampleType* samples) noexcept;
+
+    template <size_t frameWidth>
+    static void deinterleave(const SampleType* samples, const juce::dsp::AudioBlock<SampleType>& block,
+                             size_t firstChannel, size_t numGroupChannels,
+                             size_t start, size_t numFrames) noexcept;
+
+    /** The multi-output engine, specialised on which outputs are written, which
+        is encoded in outputs as 1 for lowpass, 2 for bandpass and 4 for highpass.
+    */
+    template <bool modulated>
+    void processMultiOutputForOutputs(int outputs,
+                                      const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                                      const juce::dsp::AudioBlock<SampleType>& lowpassBlock,
+                                      const juce::dsp::AudioBlock<SampleType>& bandpassBlock,
+                                      const juce::dsp::AudioBlock<SampleType>& highpassBlock) noexcept;
+
+    template <bool modulated, bool writeLP, bool writeBP, bool writeHP>
+    void processMultiOutputBlock(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                                 const juce::dsp::AudioBlock<SampleType>& lowpassBlock,
+                                 const juce::dsp::AudioBlock<SampleType>& bandpassBlock,
+                                 const juce::dsp::AudioBlock<SampleType>& highpassBlock) noexcept;
+
+    template <bool modulated, bool writeLP, bool writeBP, bool writeHP, typename VecType>
+    void processFramesMultiOutput(const VecType* input, VecType* lowpass, VecType* bandpass, VecType* highpass,
+                                  size_t numFrames, VecType& state1, VecType& state2) const noexcept;
 
     //==============================================================================
     SampleType g, h, R2;
-    std::vector<SampleType> s1{ 2 }, s2{ 2 };
 
-    double sampleRate = 44100.0;
-    Type filterType = Type::LP2;
+    /** The coefficients of each cascaded stage. The damping of a stage is
+        stageR2Offset + stageR2Scale * R2, so only the last one follows the
+        resonance.
+    */
+    std::array<SampleType, maxNumStages> stageH {}, stageR2 {}, stageR2Offset {}, stageR2Scale {};
+
+    /** The state variables, one per channel and stage, stored stage by stage.
+        The channels of each stage are padded up to a whole number of SIMD
+        registers, stateStride in all, so that each group of numLanes channels can
+        be loaded directly. s1 and s2 point into fixedState, or into stateData for
+        a dynamic channel count, and s3, the saturator's last input, follows them.
+        b1, b2 and b3 hold the later stages of the other cascading type's
+        cascade in the same way, see updateCascades(). Every stage is allocated
+        up front so that the number of stages can change while processing.
+    */
+    alignas (alignof (SIMDType)) std::array<SampleType, 6 * maxNumStages * numFixedPaddedChannels> fixedState {};
+    juce::HeapBlock<char> stateData;
+    SampleType* s1 = nullptr;
+    SampleType* s2 = nullptr;
+    SampleType* s3 = nullptr;
+    SampleType* b1 = nullptr;
+    SampleType* b2 = nullptr;
+    SampleType* b3 = nullptr;
+    size_t numStateChannels = 0, stateStride = 0;
+
+    /** The cascading type whose cascade s1, s2 and s3 hold, and whether b1, b2
+        and b3 have kept up with them since the last block that blended the two.
+    */
+    Type cascadeType = Type::LP2;
+    bool otherCascadeIsLive = false;
+
+    /** Scratch space for one sub-block, allocated by the first prepare(), so
+        that only the filters that run pay for it, and an instance holds little
+        more than its state. All of it points into scratchData.
+    */
+    juce::HeapBlock<char> scratchData;
+
+    /** For interleaving channels, which a lone channel never needs. It holds
+        three sub-blocks so that processMultiOutput() can write one per output,
+        or two sub-blocks of SIMDPair frames.
+    */
+    SIMDType* interleaved = nullptr;
+    static constexpr size_t numInterleavedRegisters = NumChannels == 1 ? 0 : 3 * interleavedBlockSize;
+
+    /** Per-sample coefficients and mix proportions for a sub-block. */
+    SampleType* modulatedG = nullptr;
+    SampleType* modulatedH = nullptr;
+    SampleType* modulatedR2 = nullptr;
+    SampleType* modulatedMix = nullptr;
+
+    /** Per-sample h of each cascaded stage, stage by stage, filled only while
+        cascading.
+    */
+    SampleType* modulatedStageH = nullptr;
+
+    /** Per-sample output weights, output by output, filled only while weighted.
+        Cascades only blend LP2 and HP2, whose weights don't follow the damping,
+        so every stage shares them.
+    */
+    SampleType* modulatedWeights = nullptr;
+
+    /** Per-sample drives and their reciprocals, filled only while saturating. */
+    SampleType* modulatedDrive = nullptr;
+    SampleType* modulatedInverseDrive = nullptr;
+
+    juce::SmoothedValue<SampleType, juce::ValueSmoothingTypes::Multiplicative> cutoffSmoother, resonanceSmoother;
+    juce::SmoothedValue<SampleType> mixSmoother, driveSmoother;
+
+    /** The morph proportion, and the crossfade from typeFadeWeights, from 0 to 1,
+        after a change of type or morph type.
+    */
+    juce::SmoothedValue<SampleType> morphSmoother, typeFadeSmoother;
+    OutputWeights typeFadeWeights;
+    double rampDurationSeconds = 0.0;
+
+    double sampleRate = 44100.0, piOverSampleRate = juce::MathConstants<double>::pi / 44100.0;
+    Type filterType = Type::LP2, morphType = Type::LP2;
+    SampleType morphProportion = static_cast<SampleType> (0);
+    CoefficientMode coefficientMode = CoefficientMode::exact;
     SampleType cutoffFrequency = static_cast<SampleType> (1000.0), resonance = static_cast<SampleType> (1.0 / std::sqrt(2.0));
+    SampleType wetMixProportion = static_cast<SampleType> (1.0);
+    SampleType drive = static_cast<SampleType> (0);
+    size_t numStages = 1;
+    Alignment alignment = Alignment::butterworth;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE (StateVariableTPTFilter)
 };
@@ -0,0 +1,311 @@
+/*
+  ==============================================================================
+
+    SVFBank.cpp
+    Created: 17 Oct 2026 10:12:48am
+    Author:  StoneyDSP
+
+  ==============================================================================
+*/
+
+#include "SVFBank.h"
+
+//==============================================================================
+namespace
+{
+    /** Returns the first SIMD aligned element at or after the given raw storage. */
+    template <typename SampleType>
+    SampleType* getSIMDAlignedPtr(char* data) noexcept
+    {
+       #if JUCE_USE_SIMD
+        return juce::dsp::SIMDRegister<SampleType>::getNextSIMDAlignedPtr(reinterpret_cast<SampleType*> (data));
+       #else
+        return reinterpret_cast<SampleType*> (data);
+       #endif
+    }
+
+    /** The number of per-filter arrays carved out of the bank's storage. */
+    constexpr size_t numBankArrays = 17;
+}
+
+//==============================================================================
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::setType(size_t filter, Type newType)
+{
+    jassert(filter < numFilters);
+
+    types[filter] = newType;
+
+    // Every type is a linear combination of the lowpass, bandpass and highpass
+    // outputs and the input: a + b * R2 of each output, plus wX of the input.
+    auto set = [this, filter](SampleType lp, SampleType bp, SampleType hp,
+                              SampleType lpR2, SampleType bpR2, SampleType hpR2, SampleType x)
+    {
+        aL[filter] = lp;
+        aB[filter] = bp;
+        aH[filter] = hp;
+        bL[filter] = lpR2;
+        bB[filter] = bpR2;
+        bH[filter] = hpR2;
+        wX[filter] = x;
+    };
+
+    switch (newType)
+    {
+    case Type::LP2:         set(1, 0, 0, 0, 0, 0, 0); break;
+    case Type::LP1:         set(1, 1, 0, 0, 0, 0, 0); break;
+    case Type::LP2n:        set(0, 0, 0, 1, 0, 0, 0); break;
+    case Type::HP2:         set(0, 0, 1, 0, 0, 0, 0); break;
+    case Type::HP1:         set(0, 1, 1, 0, 0, 0, 0); break;
+    case Type::HP2n:        set(0, 0, 0, 0, 0, 1, 0); break;
+    case Type::BP2:         set(0, 1, 0, 0, 0, 0, 0); break;
+    case Type::BP2n:        set(0, 0, 0, 0, 1, 0, 0); break;
+    case Type::AP2:         set(0, 0, 0, 0, -2, 0, 1); break;
+    case Type::P2:          set(1, 0, -1, 0, 0, 0, 0); break;
+    case Type::N2:          set(1, 0, 1, 0, 0, 0, 0); break;
+    default:                set(1, 0, 0, 0, 0, 0, 0); break;
+    }
+
+    coefficientsChanged = true;
+}
+
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::setCutoffFrequency(size_t filter, SampleType newFrequencyHz)
+{
+    jassert(filter < numFilters);
+    jassert(juce::isPositiveAndBelow(newFrequencyHz, static_cast<SampleType> (sampleRate * 0.5)));
+
+    cutoffs[filter] = newFrequencyHz;
+    coefficientsChanged = true;
+}
+
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::setResonance(size_t filter, SampleType newResonance)
+{
+    jassert(filter < numFilters);
+    jassert(newResonance > static_cast<SampleType> (0));
+
+    resonances[filter] = newResonance;
+    coefficientsChanged = true;
+}
+
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::setCutoffFrequencies(const SampleType* newFrequenciesHz)
+{
+    std::copy(newFrequenciesHz, newFrequenciesHz + numFilters, cutoffs);
+    coefficientsChanged = true;
+}
+
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::setResonances(const SampleType* newResonances)
+{
+    std::copy(newResonances, newResonances + numFilters, resonances);
+    coefficientsChanged = true;
+}
+
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::setCoefficientMode(CoefficientMode newMode)
+{
+    coefficientMode = newMode;
+    coefficientsChanged = true;
+}
+
+//==============================================================================
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    jassert(spec.sampleRate > 0);
+    jassert(spec.numChannels > 0);
+
+    sampleRate = spec.sampleRate;
+    piOverSampleRate = juce::MathConstants<double>::pi / sampleRate;
+
+    numFilters = spec.numChannels;
+    numPaddedFilters = ((numFilters + numLanes - 1) / numLanes) * numLanes;
+
+    data.allocate(numBankArrays * numPaddedFilters * sizeof(SampleType) + sizeof(SIMDType), true);
+    types.allocate(numPaddedFilters, true);
+
+    auto* next = getSIMDAlignedPtr<SampleType>(data.getData());
+
+    for (auto* array : { &cutoffs, &resonances, &g, &h, &R2, &aL, &aB, &aH, &bL, &bB, &bH,
+                         &wL, &wB, &wH, &wX, &s1, &s2 })
+    {
+        *array = next;
+        next += numPaddedFilters;
+    }
+
+    // The padding filters run too, on silence, so they get sensible settings.
+    std::fill(cutoffs, cutoffs + numPaddedFilters, static_cast<SampleType> (1000.0));
+    std::fill(resonances, resonances + numPaddedFilters, static_cast<SampleType> (1.0 / std::sqrt(2.0)));
+
+    for (size_t filter = 0; filter < numFilters; ++filter)
+        setType(filter, Type::LP2);
+
+    reset();
+    update();
+}
+
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::reset()
+{
+    for (auto v : { s1, s2 })
+        std::fill(v, v + numPaddedFilters, static_cast<SampleType> (0));
+}
+
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::reset(size_t filter)
+{
+    jassert(filter < numFilters);
+
+    s1[filter] = static_cast<SampleType> (0);
+    s2[filter] = static_cast<SampleType> (0);
+}
+
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::snapToZero() noexcept
+{
+    for (auto v : { s1, s2 })
+        for (size_t filter = 0; filter < numFilters; ++filter)
+            juce::dsp::util::snapToZero(v[filter]);
+}
+
+//==============================================================================
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::update() noexcept
+{
+    // Plain loops over the arrays, without branches, so that the compiler turns
+    // each into SIMD code, divisions included.
+    auto* lg = g;
+    auto* lh = h;
+    auto* lR2 = R2;
+    const auto* lCutoffs = cutoffs;
+    const auto* lResonances = resonances;
+
+    if (coefficientMode == CoefficientMode::fast)
+    {
+        for (size_t i = 0; i < numPaddedFilters; ++i)
+            lg[i] = static_cast<SampleType> (juce::dsp::FastMathApproximations::tan(piOverSampleRate * lCutoffs[i]));
+    }
+    else
+    {
+        for (size_t i = 0; i < numPaddedFilters; ++i)
+            lg[i] = static_cast<SampleType> (std::tan(piOverSampleRate * lCutoffs[i]));
+    }
+
+    for (size_t i = 0; i < numPaddedFilters; ++i)
+    {
+        const auto newR2 = static_cast<SampleType> (1) / lResonances[i];
+
+        lR2[i] = newR2;
+        lh[i] = static_cast<SampleType> (1) / (static_cast<SampleType> (1) + newR2 * lg[i] + lg[i] * lg[i]);
+    }
+
+    for (size_t i = 0; i < numPaddedFilters; ++i)
+    {
+        wL[i] = aL[i] + bL[i] * lR2[i];
+        wB[i] = aB[i] + bB[i] * lR2[i];
+        wH[i] = aH[i] + bH[i] * lR2[i];
+    }
+
+    coefficientsChanged = false;
+}
+
+//==============================================================================
+template <typename SampleType>
+SampleType StateVariableTPTFilterBank<SampleType>::processSample(size_t filter, SampleType inputValue) noexcept
+{
+    jassert(filter < numFilters);
+
+    if (coefficientsChanged)
+        update();
+
+    auto& ls1 = s1[filter];
+    auto& ls2 = s2[filter];
+    const auto fg = g[filter];
+
+    const auto yHP = (inputValue - ls1 * (fg + R2[filter]) - ls2) * h[filter];
+
+    const auto yBP = yHP * fg + ls1;
+    ls1 = yHP * fg + yBP;
+
+    const auto yLP = yBP * fg + ls2;
+    ls2 = yBP * fg + yLP;
+
+    return yLP * wL[filter] + yBP * wB[filter] + yHP * wH[filter] + inputValue * wX[filter];
+}
+
+template <typename SampleType>
+void StateVariableTPTFilterBank<SampleType>::processBlock(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                                                          const juce::dsp::AudioBlock<SampleType>& outputBlock) noexcept
+{
+    if (coefficientsChanged)
+        update();
+
+    const auto numSamples = outputBlock.getNumSamples();
+    auto* frames = interleaved.data();
+    auto* samples = reinterpret_cast<SampleType*> (frames);
+
+    for (size_t firstFilter = 0; firstFilter < numFilters; firstFilter += numLanes)
+    {
+        const auto numGroupFilters = juce::jmin(numLanes, numFilters - firstFilter);
+        auto load = [firstFilter](const SampleType* v) { return *reinterpret_cast<const SIMDType*> (v + firstFilter); };
+
+        // Each lane holds one filter, with its own coefficients and weights.
+        const auto lg = load(g), lh = load(h), lgR2 = load(g) + load(R2);
+        const auto lwL = load(wL), lwB = load(wB), lwH = load(wH), lwX = load(wX);
+        auto ls1 = load(s1);
+        auto ls2 = load(s2);
+
+        for (size_t start = 0; start < numSamples; start += interleavedBlockSize)
+        {
+            const auto numFrames = juce::jmin(interleavedBlockSize, numSamples - start);
+
+            for (size_t lane = 0; lane < numLanes; ++lane)
+            {
+                if (lane < numGroupFilters)
+                {
+                    const auto* src = inputBlock.getChannelPointer(firstFilter + lane) + start;
+
+                    for (size_t i = 0; i < numFrames; ++i)
+                        samples[i * numLanes + lane] = src[i];
+                }
+                else
+                {
+                    for (size_t i = 0; i < numFrames; ++i)
+                        samples[i * numLanes + lane] = static_cast<SampleType> (0);
+                }
+            }
+
+            for (size_t i = 0; i < numFrames; ++i)
+            {
+                const auto x = frames[i];
+
+                const auto yHP = (x - ls1 * lgR2 - ls2) * lh;
+
+                const auto yBP = yHP * lg + ls1;
+                ls1 = yHP * lg + yBP;
+
+                const auto yLP = yBP * lg + ls2;
+                ls2 = yBP * lg + yLP;
+
+                frames[i] = yLP * lwL + yBP * lwB + yHP * lwH + x * lwX;
+            }
+
+            for (size_t lane = 0; lane < numGroupFilters; ++lane)
+            {
+                auto* dst = outputBlock.getChannelPointer(firstFilter + lane) + start;
+
+                for (size_t i = 0; i < numFrames; ++i)
+                    dst[i] = samples[i * numLanes + lane];
+            }
+        }
+
+        *reinterpret_cast<SIMDType*> (s1 + firstFilter) = ls1;
+        *reinterpret_cast<SIMDType*> (s2 + firstFilter) = ls2;
+    }
+}
+
+//==============================================================================
+template class StateVariableTPTFilterBank<float>;
+template class StateVariableTPTFilterBank<double>;
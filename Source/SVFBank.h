@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+    SVFBank.h
+    Created: 17 Oct 2026 10:12:48am
+    Author:  StoneyDSP
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SVF.h"
+
+//==============================================================================
+/** A bank of independent StateVariableTPTFilters, one per channel, such as one
+    filter per synth voice.
+
+    Every filter has its own cutoff frequency, resonance and type. The bank keeps
+    them in structure-of-arrays form and runs numLanes filters side by side in
+    each SIMDRegister, so hundreds of filters cost about as much as a few
+    multichannel ones. The type of each filter is applied as a set of weights on
+    the lowpass, bandpass and highpass outputs and the input, which lets filters
+    of different types share a register.
+
+    Parameter changes are collected and applied at the start of the next
+    process() call, with a single pass over all the filters whose loops the
+    compiler can vectorise. The changes are not smoothed: set them once per
+    block, or per sub-block for faster modulation.
+
+    see StateVariableTPTFilter
+
+    @tags{DSP}
+*/
+template <typename SampleType>
+class StateVariableTPTFilterBank
+{
+public:
+    //==============================================================================
+    using Type = StateVariableTPTFilterType;
+    using CoefficientMode = StateVariableTPTFilterCoefficientMode;
+
+    //==============================================================================
+    /** Constructor. The bank holds no filters until prepare() is called. */
+    StateVariableTPTFilterBank() = default;
+
+    //==============================================================================
+    /** Sets the type of one filter. */
+    void setType(size_t filter, Type newType);
+
+    /** Sets the cutoff frequency of one filter in Hz. */
+    void setCutoffFrequency(size_t filter, SampleType newFrequencyHz);
+
+    /** Sets the resonance of one filter, see StateVariableTPTFilter::setResonance(). */
+    void setResonance(size_t filter, SampleType newResonance);
+
+    /** Sets the cutoff frequencies of all the filters at once, one value in Hz
+        per filter.
+    */
+    void setCutoffFrequencies(const SampleType* newFrequenciesHz);
+
+    /** Sets the resonances of all the filters at once, one value per filter. */
+    void setResonances(const SampleType* newResonances);
+
+    /** Sets how the coefficients are computed, fast (the default) or exact.
+        Only the fast mode vectorises the coefficient updates.
+    */
+    void setCoefficientMode(CoefficientMode newMode);
+
+    //==============================================================================
+    /** Returns the number of filters in the bank. */
+    size_t getNumFilters() const noexcept { return numFilters; }
+
+    /** Returns the type of one filter. */
+    Type getType(size_t filter) const noexcept { return types[filter]; }
+
+    /** Returns the cutoff frequency of one filter. */
+    SampleType getCutoffFrequency(size_t filter) const noexcept { return cutoffs[filter]; }
+
+    /** Returns the resonance of one filter. */
+    SampleType getResonance(size_t filter) const noexcept { return resonances[filter]; }
+
+    /** Returns how the coefficients of the filters are computed. */
+    CoefficientMode getCoefficientMode() const noexcept { return coefficientMode; }
+
+    //==============================================================================
+    /** Initialises the bank, with one filter per channel of the spec. Every
+        filter starts as a 1 kHz LP2 with a resonance of 1 / sqrt(2).
+    */
+    void prepare(const juce::dsp::ProcessSpec& spec);
+
+    /** Resets the internal state variables of every filter. */
+    void reset();
+
+    /** Resets the internal state variables of one filter, for example when its
+        voice starts a new note.
+    */
+    void reset(size_t filter);
+
+    /** Ensure that the state variables are rounded to zero if the state
+        variables are denormals. This is only needed if you are doing
+        sample by sample processing.
+    */
+    void snapToZero() noexcept;
+
+    //==============================================================================
+    /** Processes the input and output samples supplied in the processing context.
+        Channel i goes through filter i, so the context must have one channel per
+        filter.
+    */
+    template <typename ProcessContext>
+    void process(const ProcessContext& context) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock = context.getOutputBlock();
+
+        jassert(inputBlock.getNumChannels() == numFilters);
+        jassert(inputBlock.getNumChannels() == outputBlock.getNumChannels());
+        jassert(inputBlock.getNumSamples() == outputBlock.getNumSamples());
+
+        if (context.isBypassed)
+        {
+            outputBlock.copyFrom(inputBlock);
+            return;
+        }
+
+        processBlock(inputBlock, outputBlock);
+
+#if JUCE_DSP_ENABLE_SNAP_TO_ZERO
+        snapToZero();
+#endif
+    }
+
+    //==============================================================================
+    /** Processes one sample at a time through a given filter. */
+    SampleType processSample(size_t filter, SampleType inputValue) noexcept;
+
+private:
+    //==============================================================================
+   #if JUCE_USE_SIMD
+    using SIMDType = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr size_t numLanes = SIMDType::SIMDNumElements;
+   #else
+    using SIMDType = SampleType;
+    static constexpr size_t numLanes = 1;
+   #endif
+
+    /** Number of frames interleaved into SIMD lanes at a time. */
+    static constexpr size_t interleavedBlockSize = 128;
+
+    //==============================================================================
+    void update() noexcept;
+    void processBlock(const juce::dsp::AudioBlock<const SampleType>& inputBlock,
+                      const juce::dsp::AudioBlock<SampleType>& outputBlock) noexcept;
+
+    //==============================================================================
+    /** One array of numPaddedFilters values per field, each starting on a SIMD
+        boundary so that a group of numLanes filters loads as one register. The
+        output weights are mixed as wL * yLP + wB * yBP + wH * yHP + wX * x, where
+        wL, wB and wH are a + b * R2 for the type of each filter.
+    */
+    juce::HeapBlock<char> data;
+    SampleType* cutoffs = nullptr, * resonances = nullptr;
+    SampleType* g = nullptr, * h = nullptr, * R2 = nullptr;
+    SampleType* aL = nullptr, * aB = nullptr, * aH = nullptr, * bL = nullptr, * bB = nullptr, * bH = nullptr;
+    SampleType* wL = nullptr, * wB = nullptr, * wH = nullptr, * wX = nullptr;
+    SampleType* s1 = nullptr, * s2 = nullptr;
+    juce::HeapBlock<Type> types;
+    size_t numFilters = 0, numPaddedFilters = 0;
+
+    std::array<SIMDType, interleavedBlockSize> interleaved;
+
+    double sampleRate = 44100.0, piOverSampleRate = juce::MathConstants<double>::pi / 44100.0;
+    CoefficientMode coefficientMode = CoefficientMode::fast;
+    bool coefficientsChanged = true;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE (StateVariableTPTFilterBank)
+};
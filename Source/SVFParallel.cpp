@@ -0,0 +1,238 @@
+/*
+  ==============================================================================
+
+    SVFParallel.cpp
+    Created: 17 Oct 2026 7:26:03pm
+    Author:  StoneyDSP
+
+  ==============================================================================
+*/
+
+#include "SVFParallel.h"
+
+//==============================================================================
+template <typename SampleType>
+class ParallelStateVariableTPTFilter<SampleType>::Worker  : public juce::ThreadPoolJob
+{
+public:
+    explicit Worker(ParallelStateVariableTPTFilter& ownerToUse)
+        : juce::ThreadPoolJob("SVF slice worker"), owner(ownerToUse)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        owner.processSlices();
+        return jobHasFinished;
+    }
+
+private:
+    ParallelStateVariableTPTFilter& owner;
+};
+
+//==============================================================================
+template <typename SampleType>
+ParallelStateVariableTPTFilter<SampleType>::ParallelStateVariableTPTFilter()
+{
+}
+
+template <typename SampleType>
+ParallelStateVariableTPTFilter<SampleType>::~ParallelStateVariableTPTFilter()
+{
+    // The pool goes first, so that no worker is still running when the slices go.
+    pool.reset();
+}
+
+//==============================================================================
+template <typename SampleType>
+void ParallelStateVariableTPTFilter<SampleType>::setType(Type newType)
+{
+    filterType = newType;
+    forEachSlice([newType](Filter& f) { f.setType(newType); });
+}
+
+template <typename SampleType>
+void ParallelStateVariableTPTFilter<SampleType>::setMorphType(Type newType)
+{
+    morphType = newType;
+    forEachSlice([newType](Filter& f) { f.setMorphType(newType); });
+}
+
+template <typename SampleType>
+void ParallelStateVariableTPTFilter<SampleType>::setMorphProportion(SampleType newProportion)
+{
+    morphProportion = newProportion;
+    forEachSlice([newProportion](Filter& f) { f.setMorphProportion(newProportion); });
+}
+
+template <typename SampleType>
+void ParallelStateVariableTPTFilter<SampleType>::setDrive(SampleType newDrive)
+{
+    drive = newDrive;
+    forEachSlice([newDrive](Filter& f) { f.setDrive(newDrive); });
+}
+
+template <typename SampleType>
+void ParallelStateVariableTPTFilter<SampleType>::setCutoffFrequency(SampleType newFrequencyHz)
+{
+    cutoffFrequency = newFrequencyHz;
+    forEachSlice([newFrequencyHz](Filter& f) { f.setCutoffFrequency(newFrequencyHz); });
+}
+
+template <typename SampleType>
+void ParallelStateVariableTPTFilter<SampleType>::setResonance(SampleType newResonance)
+{
+    resonance = newResonance;
+    forEachSlice([newResonance](Filter& f) { f.setResonance(newResonance); });
+}
+
+template <typename SampleType>
+void ParallelStateVariableTPTFilter<SampleType>::setCoefficientMode(CoefficientMode newMode)
+{
+    coefficientMode = newMode;
+    forEachSlice([newMode](Filter& f) { f.setCoefficientMode(newMode); });
+}
+
+template <typename SampleType>
+void ParallelStateVariableTPTFilter<SampleType>::setRampDurationSeconds(double newDurationSeconds)
+{
+    rampDurationSeconds = newDurationSeconds;
+    forEachSlice([newDurationSeconds](Filter& f) { f.setRampDurationSeconds(newDurationSeconds); });
+}
+
+template <typename SampleType>
+void ParallelStateVariableTPTFilter<SampleType>::setWetMixProportion(SampleType newWetMixProportion)
+{
+    wetMixProportion = newWetMixProportion;
+    forEachSlice([newWetMixProportion](Filter& f) { f.setWetMixProportion(newWetMixProportion); });
+}
+
+template <typename SampleType>
+void ParallelStateVariableTPTFilter<SampleType>::setNumStages(size_t newNumStages)
+{
+    numStages = newNumStages;
+    forEachSlice([newNumStages](Filter& f) { f.setNumStages(newNumStages); });
+}
+
+template <typename SampleType>
+void ParallelStateVariableTPTFilter<SampleType>::setAlignment(Alignment newAlignment)
+{
+    alignment = newAlignment;
+    forEachSlice([newAlignment](Filter& f) { f.setAlignment(newAlignment); });
+}
+
+//==============================================================================
+template <typename SampleType>
+void ParallelStateVariableTPTFilter<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    if ((size_t) spec.numChannels != numChannels)
+    {
+        numChannels = (size_t) spec.numChannels;
+        slices.clear();
+
+        for (size_t firstChannel = 0; firstChannel < numChannels; firstChannel += numChannelsPerSlice)
+        {
+            auto slice = std::make_unique<Slice>();
+            slice->firstChannel = firstChannel;
+            slice->numChannels = juce::jmin(numChannelsPerSlice, numChannels - firstChannel);
+            slices.push_back(std::move(slice));
+        }
+
+        // One thread fewer than there are cores, as the calling thread takes
+        // slices too. On a single core there is nothing to gain.
+        const auto numThreads = juce::jmax(0, juce::SystemStats::getNumCpus() - 1);
+        const auto numWorkers = juce::jmin((size_t) numThreads, slices.empty() ? (size_t) 0 : slices.size() - 1);
+
+        if (numWorkers > 0 && pool == nullptr)
+            pool = std::make_unique<juce::ThreadPool>(numThreads);
+
+        while (workers.size() < numWorkers)
+            workers.push_back(std::make_unique<Worker>(*this));
+
+        workers.resize(numWorkers);
+    }
+
+    for (auto& slice : slices)
+    {
+        auto sliceSpec = spec;
+        sliceSpec.numChannels = (juce::uint32) slice->numChannels;
+
+        auto& f = slice->filter;
+        f.prepare(sliceSpec);
+        f.setType(filterType);
+        f.setMorphType(morphType);
+        f.setCoefficientMode(coefficientMode);
+        f.setRampDurationSeconds(rampDurationSeconds);
+        f.setCutoffFrequency(cutoffFrequency);
+        f.setResonance(resonance);
+        f.setWetMixProportion(wetMixProportion);
+        f.setNumStages(numStages);
+        f.setAlignment(alignment);
+        f.setMorphProportion(morphProportion);
+        f.setDrive(drive);
+        f.reset();
+    }
+}
+
+template <typename SampleType>
+void ParallelStateVariableTPTFilter<SampleType>::reset()
+{
+    forEachSlice([](Filter& f) { f.reset(); });
+}
+
+template <typename SampleType>
+double ParallelStateVariableTPTFilter<SampleType>::getTailLengthSeconds(double decayDecibels) const noexcept
+{
+    return slices.empty() ? 0.0 : slices.front()->filter.getTailLengthSeconds(decayDecibels);
+}
+
+template <typename SampleType>
+SampleType ParallelStateVariableTPTFilter<SampleType>::getStateMagnitude() const noexcept
+{
+    auto magnitude = static_cast<SampleType> (0);
+
+    for (auto& slice : slices)
+        magnitude = juce::jmax(magnitude, slice->filter.getStateMagnitude());
+
+    return magnitude;
+}
+
+//==============================================================================
+template <typename SampleType>
+void ParallelStateVariableTPTFilter<SampleType>::process(const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept
+{
+    currentBlock = context.getOutputBlock();
+    currentBlockIsBypassed = context.isBypassed;
+    nextSlice = 0;
+
+    jassert(currentBlock.getNumChannels() == numChannels);
+
+    for (auto& worker : workers)
+        pool->addJob(worker.get(), false);
+
+    processSlices();
+
+    for (auto& worker : workers)
+        pool->waitForJobToFinish(worker.get(), -1);
+}
+
+template <typename SampleType>
+void ParallelStateVariableTPTFilter<SampleType>::processSlices() noexcept
+{
+    // The workers don't inherit the calling thread's floating point mode.
+    juce::ScopedNoDenormals noDenormals;
+
+    for (auto index = nextSlice++; index < slices.size(); index = nextSlice++)
+    {
+        auto& slice = *slices[index];
+        auto block = currentBlock.getSubsetChannelBlock(slice.firstChannel, slice.numChannels);
+        auto context = juce::dsp::ProcessContextReplacing<SampleType>(block);
+        context.isBypassed = currentBlockIsBypassed;
+
+        slice.filter.process(context);
+    }
+}
+
+//==============================================================================
+template class ParallelStateVariableTPTFilter<float>;
+template class ParallelStateVariableTPTFilter<double>;
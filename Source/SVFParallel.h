@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    SVFParallel.h
+    Created: 17 Oct 2026 7:26:03pm
+    Author:  StoneyDSP
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SVF.h"
+
+//==============================================================================
+/** A StateVariableTPTFilter for very wide buses, which splits the channels into
+    slices and runs the slices on a pool of worker threads.
+
+    Each slice is a filter of its own, with its own cache line aligned state and
+    scratch space, so the threads never write to the same memory. The calling
+    thread and the workers take the next unprocessed slice from a shared counter
+    until there are none left, so a slow thread simply ends up with fewer
+    slices. process() returns once every slice is done.
+
+    Waiting for the workers can block, so use this for offline rendering only;
+    in real time the plain filter is the better choice whatever the channel
+    count. The interface matches that of StateVariableTPTFilter, so the two are
+    interchangeable in generic code.
+
+    see StateVariableTPTFilter
+
+    @tags{DSP}
+*/
+template <typename SampleType>
+class ParallelStateVariableTPTFilter
+{
+public:
+    //==============================================================================
+    using Filter = StateVariableTPTFilter<SampleType>;
+    using Type = StateVariableTPTFilterType;
+    using CoefficientMode = StateVariableTPTFilterCoefficientMode;
+    using Alignment = StateVariableTPTFilterAlignment;
+
+    /** Channels per slice: whole SIMDPairs at any SIMD width up to AVX, and
+        enough work to be worth handing to another thread.
+    */
+    static constexpr size_t numChannelsPerSlice = 16;
+
+    //==============================================================================
+    ParallelStateVariableTPTFilter();
+    ~ParallelStateVariableTPTFilter();
+
+    //==============================================================================
+    void setType(Type newType);
+    void setMorphType(Type newType);
+    void setMorphProportion(SampleType newProportion);
+    void setDrive(SampleType newDrive);
+    void setCutoffFrequency(SampleType newFrequencyHz);
+    void setResonance(SampleType newResonance);
+    void setCoefficientMode(CoefficientMode newMode);
+    void setRampDurationSeconds(double newDurationSeconds);
+    void setWetMixProportion(SampleType newWetMixProportion);
+    void setNumStages(size_t newNumStages);
+    void setAlignment(Alignment newAlignment);
+
+    //==============================================================================
+    /** Initialises the slices, and the worker threads the first time. Preparing
+        again for the same channel count doesn't allocate.
+    */
+    void prepare(const juce::dsp::ProcessSpec& spec);
+
+    /** Resets the internal state variables of every slice. */
+    void reset();
+
+    /** Returns the tail length of the filter, see StateVariableTPTFilter. */
+    double getTailLengthSeconds(double decayDecibels = 120.0) const noexcept;
+
+    /** Returns the largest state variable of any slice. */
+    SampleType getStateMagnitude() const noexcept;
+
+    /** Processes the block in slices spread over the worker threads and the
+        calling thread, and returns when they are all done.
+    */
+    void process(const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept;
+
+private:
+    //==============================================================================
+    struct Slice
+    {
+        Filter filter;
+        size_t firstChannel = 0, numChannels = 0;
+    };
+
+    /** Takes slices from the shared counter until there are none left. */
+    class Worker;
+
+    void processSlices() noexcept;
+
+    template <typename Function>
+    void forEachSlice(Function&& function)
+    {
+        for (auto& slice : slices)
+            function(slice->filter);
+    }
+
+    //==============================================================================
+    std::vector<std::unique_ptr<Slice>> slices;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::unique_ptr<juce::ThreadPool> pool;
+
+    size_t numChannels = 0;
+
+    juce::dsp::AudioBlock<SampleType> currentBlock;
+    bool currentBlockIsBypassed = false;
+    std::atomic<size_t> nextSlice { 0 };
+
+    /** The settings, for slices created by the next prepare(). */
+    Type filterType = Type::LP2, morphType = Type::LP2;
+    SampleType morphProportion = static_cast<SampleType> (0);
+    SampleType cutoffFrequency = static_cast<SampleType> (1000.0), resonance = static_cast<SampleType> (1.0 / std::sqrt(2.0));
+    SampleType wetMixProportion = static_cast<SampleType> (1.0);
+    SampleType drive = static_cast<SampleType> (0);
+    CoefficientMode coefficientMode = CoefficientMode::exact;
+    double rampDurationSeconds = 0.0;
+    size_t numStages = 1;
+    Alignment alignment = Alignment::butterworth;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE (ParallelStateVariableTPTFilter)
+};
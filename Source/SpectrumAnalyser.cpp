@@ -0,0 +1,330 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyser.cpp
+    Created: 17 Oct 2026 10:05:33pm
+    Author:  StoneyDSP
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyser.h"
+
+//==============================================================================
+namespace
+{
+    /** How fast the levels fall, and how long the peaks hold before they do. */
+    constexpr float levelFallDecibelsPerFrame = 48.0f / SpectrumAnalyser::frameRate;
+    constexpr float peakFallDecibelsPerFrame = 12.0f / SpectrumAnalyser::frameRate;
+    constexpr int peakHoldFrames = SpectrumAnalyser::frameRate;
+
+    /** Writes, or adds, one channel times gain into the FIFO's float samples. */
+    void mixInto(float* destination, const float* source, float gain, int numSamples, bool add) noexcept
+    {
+        if (add)
+            juce::FloatVectorOperations::addWithMultiply(destination, source, gain, numSamples);
+        else
+            juce::FloatVectorOperations::copyWithMultiply(destination, source, gain, numSamples);
+    }
+
+    void mixInto(float* destination, const double* source, float gain, int numSamples, bool add) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            destination[i] = (add ? destination[i] : 0.0f) + gain * static_cast<float> (source[i]);
+    }
+}
+
+//==============================================================================
+SpectrumAnalyser::SpectrumAnalyser()
+    : juce::Thread("SVF1 spectrum analyser")
+{
+    for (auto& channel : channels)
+    {
+        channel.fifoSamples.resize((size_t) Channel::fifoSize);
+        channel.history.resize((size_t) fftSize);
+    }
+
+    // The frequency only transform works in place over twice the FFT size.
+    fftData.resize((size_t) fftSize * 2);
+
+    const auto silence = minDecibels;
+
+    for (auto* levels : { &frame.levels, &frame.peaks })
+        for (auto& spectrum : *levels)
+            spectrum.fill(silence);
+
+    latestFrame = frame;
+}
+
+SpectrumAnalyser::~SpectrumAnalyser()
+{
+    stopThread(1000);
+}
+
+void SpectrumAnalyser::addUser()
+{
+    if (numUsers++ == 0)
+        startThread();
+}
+
+void SpectrumAnalyser::removeUser()
+{
+    jassert(numUsers.load() > 0);
+
+    if (--numUsers == 0)
+        stopThread(1000);
+}
+
+float SpectrumAnalyser::getPointFrequency(int point) noexcept
+{
+    return minFrequency * std::pow(maxFrequency / minFrequency, (float) point / (float) (numPoints - 1));
+}
+
+//==============================================================================
+template <typename SampleType>
+void SpectrumAnalyser::push(Spectrum spectrum, const juce::dsp::AudioBlock<const SampleType>& block) noexcept
+{
+    const auto numChannels = block.getNumChannels();
+
+    if (! isEnabled() || numChannels == 0)
+        return;
+
+    auto& channel = channels[(size_t) spectrum];
+    const auto gain = 1.0f / (float) numChannels;
+
+    int start1, size1, start2, size2;
+    channel.fifo.prepareToWrite((int) block.getNumSamples(), start1, size1, start2, size2);
+
+    auto write = [&channel, &block, numChannels, gain](int fifoStart, int blockStart, int numSamples)
+    {
+        auto* destination = channel.fifoSamples.data() + fifoStart;
+
+        for (size_t i = 0; i < numChannels; ++i)
+            mixInto(destination, block.getChannelPointer(i) + blockStart, gain, numSamples, i > 0);
+    };
+
+    if (size1 > 0)
+        write(start1, 0, size1);
+
+    if (size2 > 0)
+        write(start2, size1, size2);
+
+    channel.fifo.finishedWrite(size1 + size2);
+}
+
+template void SpectrumAnalyser::push<float>(Spectrum, const juce::dsp::AudioBlock<const float>&) noexcept;
+template void SpectrumAnalyser::push<double>(Spectrum, const juce::dsp::AudioBlock<const double>&) noexcept;
+
+int SpectrumAnalyser::getLatestFrame(Frame& destination) const
+{
+    const juce::SpinLock::ScopedLockType lock(latestFrameLock);
+    destination = latestFrame;
+    return numFrames.load();
+}
+
+//==============================================================================
+void SpectrumAnalyser::run()
+{
+    while (! threadShouldExit())
+    {
+        const auto rate = sampleRate.load();
+
+        if (rate != pointBinsSampleRate)
+            updatePointBins(rate);
+
+        auto anythingNew = false;
+
+        for (size_t i = 0; i < numSpectra; ++i)
+        {
+            if (drain(channels[i]))
+            {
+                analyse(channels[i], frame.levels[i], frame.peaks[i]);
+                anythingNew = true;
+            }
+        }
+
+        if (anythingNew)
+        {
+            {
+                const juce::SpinLock::ScopedLockType lock(latestFrameLock);
+                latestFrame = frame;
+            }
+
+            ++numFrames;
+        }
+
+        wait(1000 / frameRate);
+    }
+}
+
+bool SpectrumAnalyser::drain(Channel& channel)
+{
+    const auto numReady = channel.fifo.getNumReady();
+
+    if (numReady == 0)
+        return false;
+
+    int start1, size1, start2, size2;
+    channel.fifo.prepareToRead(numReady, start1, size1, start2, size2);
+
+    for (auto range : { std::make_pair(start1, size1), std::make_pair(start2, size2) })
+    {
+        // Only the last fftSize samples matter.
+        const auto skip = juce::jmax(0, range.second - fftSize);
+
+        for (int i = skip; i < range.second; ++i)
+        {
+            channel.history[(size_t) channel.historyIndex] = channel.fifoSamples[(size_t) (range.first + i)];
+            channel.historyIndex = (channel.historyIndex + 1) % fftSize;
+        }
+    }
+
+    channel.fifo.finishedRead(size1 + size2);
+    return true;
+}
+
+void SpectrumAnalyser::analyse(Channel& channel, std::array<float, numPoints>& levels, std::array<float, numPoints>& peaks)
+{
+    // Oldest first.
+    const auto numToEnd = (size_t) (fftSize - channel.historyIndex);
+    std::copy(channel.history.begin() + channel.historyIndex, channel.history.end(), fftData.begin());
+    std::copy(channel.history.begin(), channel.history.begin() + channel.historyIndex, fftData.begin() + (std::ptrdiff_t) numToEnd);
+
+    window.multiplyWithWindowingTable(fftData.data(), (size_t) fftSize);
+    fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+    // A full scale sine reads 0 dB: the Hann window halves the amplitude, and
+    // the transform spreads it over the positive and negative frequencies.
+    const auto scale = 4.0f / (float) fftSize;
+
+    for (int point = 0; point < numPoints; ++point)
+    {
+        auto magnitude = 0.0f;
+
+        for (auto bin = pointBins[(size_t) point]; bin < pointBins[(size_t) point + 1]; ++bin)
+            magnitude = juce::jmax(magnitude, fftData[(size_t) bin]);
+
+        const auto decibels = juce::Decibels::gainToDecibels(magnitude * scale, minDecibels);
+        auto& level = levels[(size_t) point];
+        auto& peak = peaks[(size_t) point];
+        auto& holdFrames = channel.peakHoldFrames[(size_t) point];
+
+        level = juce::jmax(decibels, level - levelFallDecibelsPerFrame);
+
+        if (decibels >= peak)
+        {
+            peak = decibels;
+            holdFrames = peakHoldFrames;
+        }
+        else if (holdFrames > 0)
+        {
+            --holdFrames;
+        }
+        else
+        {
+            peak = juce::jmax(minDecibels, peak - peakFallDecibelsPerFrame);
+        }
+    }
+}
+
+void SpectrumAnalyser::updatePointBins(double newSampleRate)
+{
+    pointBinsSampleRate = newSampleRate;
+
+    const auto binsPerHz = (double) fftSize / newSampleRate;
+    const auto maxBin = fftSize / 2;
+
+    // Each point covers the bins from its own frequency to the next point's,
+    // and at least one, as the low points are closer together than the bins.
+    for (int point = 0; point <= numPoints; ++point)
+    {
+        const auto bin = juce::roundToInt(getPointFrequency(point) * binsPerHz);
+        pointBins[(size_t) point] = juce::jlimit(1, maxBin, bin);
+    }
+
+    for (int point = 0; point < numPoints; ++point)
+        pointBins[(size_t) point + 1] = juce::jmin(maxBin + 1, juce::jmax(pointBins[(size_t) point + 1], pointBins[(size_t) point] + 1));
+}
+
+//==============================================================================
+SpectrumAnalyserComponent::SpectrumAnalyserComponent(SpectrumAnalyser& analyserToUse)
+    : analyser(analyserToUse)
+{
+    setOpaque(true);
+
+    for (auto* path : { &inputPath, &outputPath, &peakPath })
+        path->preallocateSpace(SpectrumAnalyser::numPoints * 3 + 16);
+
+    analyser.addUser();
+    startTimerHz(SpectrumAnalyser::frameRate);
+}
+
+SpectrumAnalyserComponent::~SpectrumAnalyserComponent()
+{
+    stopTimer();
+    analyser.removeUser();
+}
+
+void SpectrumAnalyserComponent::timerCallback()
+{
+    const auto numFrames = analyser.getLatestFrame(frame);
+
+    if (numFrames != lastFrame)
+    {
+        lastFrame = numFrames;
+        repaint();
+    }
+}
+
+void SpectrumAnalyserComponent::createPath(juce::Path& path, const std::array<float, SpectrumAnalyser::numPoints>& levels,
+                                           juce::Rectangle<float> area) const
+{
+    path.clear();
+
+    for (int point = 0; point < SpectrumAnalyser::numPoints; ++point)
+    {
+        const auto x = area.getX() + area.getWidth() * (float) point / (float) (SpectrumAnalyser::numPoints - 1);
+        const auto y = juce::jmap(levels[(size_t) point], SpectrumAnalyser::minDecibels, 0.0f, area.getBottom(), area.getY());
+
+        if (point == 0)
+            path.startNewSubPath(x, y);
+        else
+            path.lineTo(x, y);
+    }
+}
+
+void SpectrumAnalyserComponent::paint(juce::Graphics& g)
+{
+    const auto area = getLocalBounds().toFloat();
+    g.fillAll(juce::Colours::black);
+
+    // Decades and every 24 dB.
+    g.setColour(juce::Colours::white.withAlpha(0.1f));
+
+    for (auto frequency : { 100.0f, 1000.0f, 10000.0f })
+    {
+        const auto proportion = std::log(frequency / SpectrumAnalyser::minFrequency)
+                                / std::log(SpectrumAnalyser::maxFrequency / SpectrumAnalyser::minFrequency);
+        g.drawVerticalLine(juce::roundToInt(area.getX() + area.getWidth() * proportion), area.getY(), area.getBottom());
+    }
+
+    for (auto decibels = -24.0f; decibels > SpectrumAnalyser::minDecibels; decibels -= 24.0f)
+        g.drawHorizontalLine(juce::roundToInt(juce::jmap(decibels, SpectrumAnalyser::minDecibels, 0.0f, area.getBottom(), area.getY())),
+                             area.getX(), area.getRight());
+
+    createPath(inputPath, frame.levels[SpectrumAnalyser::input], area);
+    inputPath.lineTo(area.getBottomRight());
+    inputPath.lineTo(area.getBottomLeft());
+    inputPath.closeSubPath();
+
+    g.setColour(juce::Colours::grey.withAlpha(0.5f));
+    g.fillPath(inputPath);
+
+    createPath(outputPath, frame.levels[SpectrumAnalyser::output], area);
+    g.setColour(juce::Colours::orange);
+    g.strokePath(outputPath, juce::PathStrokeType(1.5f));
+
+    createPath(peakPath, frame.peaks[SpectrumAnalyser::output], area);
+    g.setColour(juce::Colours::orange.withAlpha(0.4f));
+    g.strokePath(peakPath, juce::PathStrokeType(1.0f));
+}
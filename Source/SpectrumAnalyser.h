@@ -0,0 +1,170 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyser.h
+    Created: 17 Oct 2026 10:05:33pm
+    Author:  StoneyDSP
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/** Input and output spectra of the plugin, for the editor.
+
+    The audio thread mixes each block down to mono and pushes it into a wait-free
+    single producer, single consumer FIFO, one for the input and one for the
+    output. Nothing else happens there: no allocation, no lock, and no work at
+    all unless an editor uses the analyser (see addUser()).
+
+    A background thread drains the FIFOs at the display rate, windows the most
+    recent fftSize samples, transforms them and reduces the bins to numPoints
+    log-spaced levels with a falling ballistic and a peak hold. All of its
+    buffers are allocated up front. The editor picks up finished frames with
+    getLatestFrame().
+*/
+class SpectrumAnalyser  : private juce::Thread
+{
+public:
+    //==============================================================================
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+
+    /** Levels per spectrum, log-spaced from minFrequency to maxFrequency. */
+    static constexpr int numPoints = 256;
+    static constexpr float minFrequency = 20.0f, maxFrequency = 20000.0f;
+
+    /** Levels at or below this read as silence. */
+    static constexpr float minDecibels = -96.0f;
+
+    /** Frames computed per second, at most. */
+    static constexpr int frameRate = 60;
+
+    enum Spectrum
+    {
+        input,
+        output,
+        numSpectra
+    };
+
+    /** Levels in dB, for each spectrum and point. */
+    struct Frame
+    {
+        std::array<std::array<float, numPoints>, numSpectra> levels, peaks;
+    };
+
+    //==============================================================================
+    SpectrumAnalyser();
+    ~SpectrumAnalyser() override;
+
+    /** Sets the sample rate that the pushed samples run at. */
+    void prepare(double newSampleRate) noexcept { sampleRate = newSampleRate; }
+
+    /** True while anything is showing the spectra. */
+    bool isEnabled() const noexcept { return numUsers.load() > 0; }
+
+    /** Starts the analysis for one more reader, such as an open editor. Call
+        removeUser() when done. Message thread only.
+    */
+    void addUser();
+    void removeUser();
+
+    /** Mixes the block down and hands it to the analysis thread, in float
+        whatever the block holds. Never blocks; samples that don't fit in the
+        FIFO are dropped. Audio thread only.
+    */
+    template <typename SampleType>
+    void push(Spectrum spectrum, const juce::dsp::AudioBlock<const SampleType>& block) noexcept;
+
+    /** Copies the most recent frame, and returns the number of frames computed
+        so far, so that callers can tell whether there is a new one.
+    */
+    int getLatestFrame(Frame& destination) const;
+
+    /** Returns the frequency in Hz of a point. */
+    static float getPointFrequency(int point) noexcept;
+
+private:
+    //==============================================================================
+    struct Channel
+    {
+        static constexpr int fifoSize = 1 << 15;
+
+        juce::AbstractFifo fifo { fifoSize };
+        std::vector<float> fifoSamples;
+
+        /** The last fftSize samples, in a circle starting at historyIndex. */
+        std::vector<float> history;
+        int historyIndex = 0;
+
+        /** When each point's peak starts to fall, in frames. */
+        std::array<int, numPoints> peakHoldFrames {};
+    };
+
+    void run() override;
+
+    /** Moves whatever is in the FIFO into the history. Returns false if there
+        was nothing new.
+    */
+    bool drain(Channel& channel);
+
+    void analyse(Channel& channel, std::array<float, numPoints>& levels, std::array<float, numPoints>& peaks);
+    void updatePointBins(double newSampleRate);
+
+    //==============================================================================
+    std::array<Channel, numSpectra> channels;
+
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> window { (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false };
+    std::vector<float> fftData;
+
+    /** The FFT bins each point takes the largest of, from pointBins[i] up to,
+        but not including, pointBins[i + 1].
+    */
+    std::array<int, numPoints + 1> pointBins {};
+    double pointBinsSampleRate = 0.0;
+
+    Frame frame, latestFrame;
+    mutable juce::SpinLock latestFrameLock;
+    std::atomic<int> numFrames { 0 };
+
+    std::atomic<int> numUsers { 0 };
+    std::atomic<double> sampleRate { 44100.0 };
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumAnalyser)
+};
+
+//==============================================================================
+/** Draws a SpectrumAnalyser's input as a filled area under its output, with the
+    output's peaks on top. It repaints at most at the analyser's frame rate, and
+    only when there is a new frame.
+*/
+class SpectrumAnalyserComponent  : public juce::Component,
+                                   private juce::Timer
+{
+public:
+    explicit SpectrumAnalyserComponent(SpectrumAnalyser& analyserToUse);
+    ~SpectrumAnalyserComponent() override;
+
+    void paint(juce::Graphics& g) override;
+
+private:
+    void timerCallback() override;
+
+    /** Fills a path with one spectrum's levels across the given area. */
+    void createPath(juce::Path& path, const std::array<float, SpectrumAnalyser::numPoints>& levels,
+                    juce::Rectangle<float> area) const;
+
+    SpectrumAnalyser& analyser;
+    SpectrumAnalyser::Frame frame;
+    int lastFrame = 0;
+
+    /** Reused from one repaint to the next, so that they keep their storage. */
+    juce::Path inputPath, outputPath, peakPath;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumAnalyserComponent)
+};